@@ -92,6 +92,9 @@ for i = 1, #arg do
   end
 end
 if not lfs.attributes(_USERHOME) then lfs.mkdir(_USERHOME) end
+-- Bytecode cache used by Textadept's C core when loading Lua files.
+local cache = _USERHOME..'/cache'
+if not lfs.attributes(cache) then lfs.mkdir(cache) end
 local f = io.open(_USERHOME..'/init.lua', 'a+') -- ensure existence
 if f then f:close() end
 
@@ -171,6 +171,19 @@ local M = {}
 --
 --   * _`menu_id`_: The numeric ID of the menu item, which was defined in
 --     [`ui.menu()`]().
+-- @field MODIFIED_RANGE (string)
+--   Emitted after text is inserted into or deleted from a buffer.
+--   Modifications made within a bulk scope (see [`buffer.begin_bulk()`]()),
+--   undo action, or [`buffer:batch()`]() are coalesced into a single event
+--   emitted when the outermost scope ends. Other modifications are coalesced
+--   until control returns to the main loop.
+--   Arguments:
+--
+--   * _`start_pos`_: The start position of the range of modified text.
+--   * _`end_pos`_: The end position of the range of modified text. Deleted
+--     text does not count towards the range.
+--   * _`lines_added`_: The net number of lines added, which may be negative.
+--   * _`buffer`_: The buffer modified, which may not be the current one.
 -- @field MOUSE (string)
 --   Emitted by the terminal version for an unhandled mouse event.
 --   Arguments:
@@ -261,9 +274,41 @@ local M = {}
 -- @field VIEW_AFTER_SWITCH (string)
 --   Emitted right after switching to another view.
 --   Emitted by [`ui.goto_view()`]().
+-- @field profile (bool)
+--   Collect call counts, elapsed times, and allocation counts for events and
+--   their handlers.
+--   Allocation counts are not available when Textadept is built against
+--   LuaJIT.
+--   The default value is `false`.
+--   See [`events.stats()`]() and [`events.print_stats()`]().
+-- @field slow_handler_time (number)
+--   The number of milliseconds an `events.KEYPRESS` or `events.UPDATE_UI`
+--   handler may take before it is reported as slow in an `events.ERROR`
+--   event.
+--   `0` disables logging.
+--   The default value is `0`.
 module('events')]]
 
+-- Map of monitoring settings to their values.
+-- Assigning one through `M` tells Textadept's C core, which keeps copies so
+-- that emitting events does not look them up.
+local settings = {profile = false, slow_handler_time = 0}
+setmetatable(M, {__index = settings, __newindex = function(t, k, v)
+  if k ~= 'profile' and k ~= 'slow_handler_time' then rawset(t, k, v) return end
+  settings[k] = v
+  if not M._monitor then return end
+  M._monitor(settings.profile, settings.slow_handler_time)
+end})
+
+-- Map of event names to lists of handlers.
+-- Textadept's C core reads this table directly when emitting events.
 local handlers = {}
+M._handlers = handlers
+
+-- Map of event names to event statistics.
+-- Textadept's C core updates this table directly when `M.profile` is `true`.
+local stats = {}
+M._stats = stats
 
 ---
 -- Adds function *f* to the set of event handlers for event *event* at position
@@ -314,6 +359,8 @@ local error_emitted = false
 -- @name emit
 function M.emit(event, ...)
   assert(event, _L['Undefined event name'])
+  -- Once initialized, Textadept's C core calls handlers and collects stats.
+  if M._emit then return M._emit(event, ...) end
   local h = handlers[event]
   if not h then return end
   for i = 1, #h do
@@ -332,8 +379,65 @@ function M.emit(event, ...)
   end
 end
 
+---
+-- Returns a table of event statistics collected while `events.profile` is
+-- `true`.
+-- Keys are event names and values are tables with `calls`, `time`, `max_time`,
+-- `allocs`, `slow`, and `handlers` fields. Times are in seconds. `handlers`
+-- maps each handler function called to a table of that handler's statistics,
+-- with the same fields except for `handlers`.
+-- @param clear Optional flag indicating whether or not to clear collected
+--   statistics. The default value is `false`.
+-- @return table of statistics
+-- @see print_stats
+-- @name stats
+function M.stats(clear)
+  local t = {}
+  for event, s in pairs(stats) do t[event] = s end
+  if clear then for event in pairs(t) do stats[event] = nil end end
+  return t
+end
+
+-- Returns a list of the keys in table *t* sorted by descending total time.
+-- @param t Table of statistics tables.
+local function by_time(t)
+  local keys = {}
+  for k in pairs(t) do keys[#keys + 1] = k end
+  table.sort(keys, function(a, b) return t[a].time > t[b].time end)
+  return keys
+end
+
+---
+-- Prints to the message buffer a report of event statistics collected while
+-- `events.profile` is `true`, with the slowest events and handlers first.
+-- @see stats
+-- @name print_stats
+function M.print_stats()
+  local format = '%-40s %8s %10s %10s %10s %5s'
+  ui.print(format:format('event/handler', 'calls', 'total (ms)', 'max (ms)',
+                         'allocs', 'slow'))
+  local function print_stats(name, s)
+    ui.print(format:format(name, s.calls, ('%.2f'):format(s.time * 1000),
+                           ('%.2f'):format(s.max_time * 1000), s.allocs,
+                           s.slow))
+  end
+  for _, event in ipairs(by_time(stats)) do
+    print_stats(event, stats[event])
+    local handlers = stats[event].handlers
+    for _, f in ipairs(by_time(handlers)) do
+      local info = debug.getinfo(f, 'S')
+      print_stats(('  %s:%d'):format(info.short_src, info.linedefined),
+                  handlers[f])
+    end
+  end
+end
+
 --- Map of Scintilla notifications to their handlers.
 local c = _SCINTILLA.constants
+-- Map of Scintilla notification codes to event names and notification fields
+-- to pass to handlers.
+-- Textadept's C core reads this table directly in order to skip notifications
+-- that have no handlers.
 local scnotifications = {
   [c.SCN_CHARADDED] = {'char_added', 'ch'},
   [c.SCN_SAVEPOINTREACHED] = {'save_point_reached'},
@@ -357,23 +461,26 @@ local scnotifications = {
   [c.SCN_AUTOCCHARDELETED] = {'auto_c_char_deleted'},
   [c.SCN_AUTOCCOMPLETED] = {'auto_c_completed', 'text', 'position'},
 }
+M._scnotifications = scnotifications
 
 -- Handles Scintilla notifications.
-M.connect('SCN', function(n)
+-- Textadept's C core only emits unmapped notifications and every modification
+-- notification while other 'SCN' handlers are connected.
+local function scnotify(n)
   local f = scnotifications[n.code]
   if not f then return end
-  local args = {}
-  for i = 2, #f do args[i - 1] = n[f[i]] end
-  return M.emit(f[1], table.unpack(args))
-end)
+  return M.emit(f[1], n[f[2]], n[f[3]], n[f[4]])
+end
+M._scnotify = scnotify
+M.connect('SCN', scnotify)
 
 -- Set event constants.
 for _, n in pairs(scnotifications) do M[n[1]:upper()] = n[1] end
 local textadept_events = {
   'appleevent_odoc', 'buffer_after_switch', 'buffer_before_switch',
   'buffer_deleted', 'buffer_new', 'csi', 'error', 'find', 'focus',
-  'initialized', 'keypress', 'menu_clicked', 'mouse', 'quit', 'replace',
-  'replace_all', 'reset_after', 'reset_before', 'resume', 'suspend',
+  'initialized', 'keypress', 'menu_clicked', 'modified_range', 'mouse', 'quit',
+  'replace', 'replace_all', 'reset_after', 'reset_before', 'resume', 'suspend',
   'tab_clicked', 'view_after_switch', 'view_before_switch', 'view_new'
 }
 for _, e in pairs(textadept_events) do M[e:upper()] = e end
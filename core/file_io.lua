@@ -17,7 +17,8 @@
 --   * _`filename`_: The filename of the file being saved.
 -- @field _G.events.FILE_AFTER_SAVE (string)
 --   Emitted right after saving a file to disk.
---   Emitted by [`io.save_file()`]() and [`io.save_file_as()`]().
+--   Emitted by [`io.save_file()`]() and [`io.save_file_as()`]() once the file
+--   has been written, with the saved buffer as the current one.
 --   Arguments:
 --
 --   * _`filename`_: The filename of the file being saved.
@@ -25,6 +26,10 @@
 --     filename.
 -- @field _G.events.FILE_CHANGED (string)
 --   Emitted when Textadept detects that an open file was modified externally.
+--   On Linux, open files are watched for changes and this is emitted as soon as
+--   the current buffer's file changes, or when switching to a buffer whose file
+--   changed in the meantime. Elsewhere, files are checked for changes when
+--   switching buffers or views and when Textadept regains focus.
 --   When connecting to this event, connect with an index of 1 in order to
 --   override the default prompt to reload the file.
 --   Arguments:
@@ -33,6 +38,15 @@
 -- @field quick_open_max (number)
 --   The maximum number of files listed in the quick open dialog.
 --   The default value is `1000`.
+-- @field large_file_size (number)
+--   The size in bytes at or above which an opened file is a large file.
+--   Large files are not lexed or folded, do not keep undo history, and are not
+--   searched as a whole by features like word highlighting. See
+--   [`buffer.large_file`]().
+--   The default value is `67108864` (64 MB).
+-- @field large_file_lines (number)
+--   The number of lines at or above which an opened file is a large file.
+--   The default value is `1000000`.
 module('io')]]
 
 -- Events.
@@ -43,6 +57,8 @@ events.FILE_AFTER_SAVE = 'file_after_save'
 events.FILE_CHANGED = 'file_changed'
 
 io.quick_open_max = 1000
+io.large_file_size = 67108864
+io.large_file_lines = 1000000
 
 ---
 -- List of recently opened files, the most recent being towards the top.
@@ -83,6 +99,28 @@ io.recent_files = {}
 -- @name encodings
 io.encodings = {'UTF-8', 'ASCII', 'ISO-8859-1', 'MacRoman'}
 
+-- Loads file *filename*, if it exists, into new buffer *buffer* after detecting
+-- its character encoding and EOL mode and converting it to UTF-8 if necessary.
+-- This is shared by `io.open_file()` and session placeholder buffers.
+function io._load_file(buffer, filename)
+  local encoding, crlf = 'UTF-8', false -- new file
+  if lfs.attributes(filename) then
+    encoding, crlf = buffer:load_file(filename, io.encodings)
+    assert(encoding ~= false, _L['Encoding conversion failed.'])
+  end
+  buffer.encoding = encoding -- nil for binary (default was 'UTF-8')
+  buffer.code_page = buffer.encoding and buffer.CP_UTF8 or 0
+  buffer.eol_mode = crlf and buffer.EOL_CRLF or buffer.EOL_LF
+  buffer:goto_pos(0)
+  buffer:empty_undo_buffer()
+  if buffer.length >= io.large_file_size or
+     buffer.line_count >= io.large_file_lines then
+    buffer.large_file = true
+    buffer.undo_collection = false
+    buffer.property['fold'] = '0'
+  end
+end
+
 ---
 -- Opens *filenames*, a string filename or list of filenames, or the
 -- user-selected filenames.
@@ -109,33 +147,16 @@ function io.open_file(filenames)
       end
     end
 
-    local text = ''
     local f, err = io.open(filename, 'rb')
     if f then
-      text = f:read('*a')
       f:close()
-      if not text then goto continue end -- filename exists, but cannot read it
+      -- Filename exists, but cannot be read as a file.
+      if lfs.attributes(filename, 'mode') == 'directory' then goto continue end
     elseif lfs.attributes(filename) then
       error(err)
     end
     local buffer = buffer.new()
-    -- Try to detect character encoding and convert to UTF-8.
-    if not text:sub(1, 65536):find('\0') then
-      for j = 1, #io.encodings do
-        local ok, conv = pcall(string.iconv, text, 'UTF-8', io.encodings[j])
-        if ok then buffer.encoding, text = io.encodings[j], conv break end
-      end
-      assert(buffer.encoding, _L['Encoding conversion failed.'])
-    else
-      buffer.encoding = nil -- binary (default was 'UTF-8')
-    end
-    buffer.code_page = buffer.encoding and buffer.CP_UTF8 or 0
-    -- Detect EOL mode.
-    buffer.eol_mode = text:find('\r\n') and buffer.EOL_CRLF or buffer.EOL_LF
-    -- Insert buffer text and set properties.
-    buffer:add_text(text, #text)
-    buffer:goto_pos(0)
-    buffer:empty_undo_buffer()
+    io._load_file(buffer, filename)
     buffer.mod_time = lfs.attributes(filename, 'modification') or os.time()
     buffer.filename = filename
     buffer:set_save_point()
@@ -155,18 +176,18 @@ end
 
 ---
 -- Reloads the current buffer's file contents, discarding any changes.
+-- Does nothing while the buffer is being saved in the background.
 -- @name reload_file
 function io.reload_file()
-  if not buffer.filename then return end
-  local pos, first_visible_line = buffer.current_pos, buffer.first_visible_line
+  if not buffer.filename or buffer._saving then return end
   local f = assert(io.open(buffer.filename, 'rb'))
   local text = f:read('*a')
   f:close()
   if buffer.encoding then text = text:iconv('UTF-8', buffer.encoding) end
-  buffer:clear_all()
-  buffer:add_text(text, #text)
-  buffer:line_scroll(0, first_visible_line)
-  buffer:goto_pos(pos)
+  local read_only = buffer.read_only
+  buffer.read_only = false
+  buffer:update_text(text)
+  buffer.read_only = read_only
   buffer:set_save_point()
   buffer.mod_time = lfs.attributes(buffer.filename, 'modification')
 end
@@ -192,22 +213,51 @@ events_connect(events.BUFFER_NEW, function()
   buffer.set_encoding, buffer.encoding = set_encoding, 'UTF-8'
 end)
 
+-- Saves the current buffer to its file in the background, emitting
+-- `FILE_AFTER_SAVE` events once the file has been written. The buffer is
+-- read-only until then.
+-- Functions added to the buffer's `_on_saved` list while it is saving are
+-- called with `true` after those events, or with `false` if the save failed.
+-- @param saved_as Whether or not the buffer is being saved under a new name.
+local function save(saved_as)
+  local buffer, filename, read_only = buffer, buffer.filename, buffer.read_only
+  buffer.read_only, buffer._saving, buffer._on_saved = true, true, {}
+  buffer:save_file(filename, buffer.encoding, function(ok, errmsg)
+    local on_saved = buffer._on_saved
+    buffer._saving, buffer._on_saved = nil, nil
+    if not _BUFFERS[buffer] then return end -- closed while saving
+    buffer.read_only = read_only
+    local function done(saved)
+      for i = 1, #on_saved do on_saved[i](saved) end
+    end
+    if not ok then done(false) end
+    assert(ok ~= false, _L['Encoding conversion failed.'])
+    assert(ok, errmsg)
+    buffer:set_save_point()
+    buffer.mod_time = lfs.attributes(filename, 'modification')
+    if buffer._type then buffer._type = nil end
+    -- Temporarily change _G.buffer since handlers act on the saved buffer.
+    local orig_buffer = _G.buffer
+    _G.buffer = buffer
+    events.emit(events.FILE_AFTER_SAVE, filename)
+    if saved_as then events.emit(events.FILE_AFTER_SAVE, filename, true) end
+    _G.buffer = orig_buffer
+    done(true)
+  end)
+end
+
 ---
 -- Saves the current buffer to its file.
+-- The file is usually written to a temporary file that replaces it once
+-- complete, and large files are written in the background. The buffer is
+-- read-only until the `FILE_AFTER_SAVE` event is emitted.
 -- Emits `FILE_BEFORE_SAVE` and `FILE_AFTER_SAVE` events.
 -- @name save_file
 function io.save_file()
   if not buffer.filename then io.save_file_as() return end
+  if buffer._saving then return end -- the text cannot have changed
   events.emit(events.FILE_BEFORE_SAVE, buffer.filename)
-  local text = buffer:get_text()
-  if buffer.encoding then text = text:iconv(buffer.encoding, 'UTF-8') end
-  local f = assert(io.open(buffer.filename, 'wb'))
-  f:write(text)
-  f:close()
-  buffer:set_save_point()
-  buffer.mod_time = lfs.attributes(buffer.filename, 'modification')
-  if buffer._type then buffer._type = nil end
-  events.emit(events.FILE_AFTER_SAVE, buffer.filename)
+  save(false)
 end
 
 ---
@@ -217,6 +267,7 @@ end
 --   user is prompted for one.
 -- @name save_file_as
 function io.save_file_as(filename)
+  if buffer._saving then return end
   local dir, name = (buffer.filename or ''):match('^(.-[/\\]?)([^/\\]*)$')
   filename = filename or ui.dialogs.filesave{
     title = _L['Save'], with_directory = dir,
@@ -225,8 +276,8 @@ function io.save_file_as(filename)
   }
   if not filename then return end
   buffer.filename = filename
-  io.save_file()
-  events.emit(events.FILE_AFTER_SAVE, filename, true)
+  events.emit(events.FILE_BEFORE_SAVE, filename)
+  save(true)
 end
 
 ---
@@ -236,8 +287,9 @@ end
 function io.save_all_files()
   local current_buffer = buffer
   for i = 1, #_BUFFERS do
-    if _BUFFERS[i].filename and _BUFFERS[i].modify then
-      view:goto_buffer(_BUFFERS[i])
+    local buffer = _BUFFERS[i]
+    if buffer.filename and not buffer._load and buffer.modify then
+      view:goto_buffer(buffer)
       io.save_file()
     end
   end
@@ -271,6 +323,12 @@ end
 -- @see io.close_buffer
 -- @name close_all_buffers
 function io.close_all_buffers()
+  -- Delete session placeholders that were never used without switching to
+  -- them, which would load them. They have no changes to save.
+  for i = #_BUFFERS, 1, -1 do
+    local buf = _BUFFERS[i]
+    if #_BUFFERS > 1 and buf._load and buf ~= buffer then buf:delete() end
+  end
   while #_BUFFERS > 1 do
     view:goto_buffer(_BUFFERS[#_BUFFERS])
     if not io.close_buffer() then return false end
@@ -278,15 +336,46 @@ function io.close_all_buffers()
   return io.close_buffer() -- the last one
 end
 
+-- Map of open filenames to whether or not they are watched for changes.
+local watched = {}
+
+-- Watches the files of open buffers for changes and stops watching files that
+-- are no longer open.
+local function update_watched_files()
+  local open = {}
+  for i = 1, #_BUFFERS do
+    local filename = _BUFFERS[i].filename
+    if filename and not _BUFFERS[i]._load then open[filename] = true end
+  end
+  for filename in pairs(watched) do
+    if not open[filename] then
+      io._unwatch_file(filename)
+      watched[filename] = nil
+    end
+  end
+  for filename in pairs(open) do
+    if watched[filename] == nil then
+      watched[filename] = io._watch_file(filename)
+    end
+  end
+end
+events_connect(events.FILE_OPENED, update_watched_files)
+events_connect(events.FILE_AFTER_SAVE, update_watched_files)
+events_connect(events.BUFFER_DELETED, update_watched_files)
+events_connect(events.INITIALIZED, update_watched_files)
+
 -- Detects if the current file has been externally modified and, if so, emits a
 -- `FILE_CHANGED` event.
+-- Watched files are only checked after a change to them has been reported.
 local function update_modified_file()
   if not buffer.filename then return end
+  if watched[buffer.filename] and not buffer._file_changed then return end
+  buffer._file_changed = nil
   local mod_time = lfs.attributes(buffer.filename, 'modification')
   if not mod_time or not buffer.mod_time then return end
   if buffer.mod_time < mod_time then
     buffer.mod_time = mod_time
-    events.emit(events.FILE_CHANGED)
+    events.emit(events.FILE_CHANGED, buffer.filename)
   end
 end
 events_connect(events.BUFFER_AFTER_SWITCH, update_modified_file)
@@ -294,6 +383,18 @@ events_connect(events.VIEW_AFTER_SWITCH, update_modified_file)
 events_connect(events.FOCUS, update_modified_file)
 events_connect(events.RESUME, update_modified_file)
 
+-- Marks the buffers of a watched file reported as changed so they are checked
+-- when switched to, and checks the current buffer right away.
+-- A file that is no longer watched is checked for changes like any other.
+events_connect('file_modified', function(filename, unwatched)
+  if unwatched then watched[filename] = nil end
+  for i = 1, #_BUFFERS do
+    local buffer = _BUFFERS[i]
+    if buffer.filename == filename then buffer._file_changed = true end
+  end
+  if buffer.filename == filename then update_modified_file() end
+end)
+
 -- Prompts the user to reload the current file if it has been externally
 -- modified.
 events_connect(events.FILE_CHANGED, function()
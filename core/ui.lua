@@ -163,7 +163,8 @@ function ui.switch_buffer()
     local filename = buffer.filename or buffer._type or _L['Untitled']
     if buffer.filename then filename = filename:iconv('UTF-8', _CHARSET) end
     local basename = buffer.filename and filename:match('[^/\\]+$') or filename
-    utf8_list[#utf8_list + 1] = (buffer.modify and '*' or '')..basename
+    local modified = not buffer._load and buffer.modify -- do not load
+    utf8_list[#utf8_list + 1] = (modified and '*' or '')..basename
     utf8_list[#utf8_list + 1] = filename
   end
   local button, i = ui.dialogs.filteredlist{
@@ -289,6 +290,40 @@ local SETDIRECTFUNCTION = _SCINTILLA.properties.direct_function[1]
 local SETDIRECTPOINTER = _SCINTILLA.properties.doc_pointer[2]
 local SETLUASTATE = _SCINTILLA.functions.change_lexer_state[1]
 local SETLEXERLANGUAGE = _SCINTILLA.properties.lexer_language[2]
+
+-- Map of lexer names to tables of their compiled lexers and the modification
+-- times of their source files. All buffers of a language share its lexer.
+local lexer_cache, cached_lexer_module = {}, nil
+local LEXERPATH = _USERHOME..'/lexers/?.lua;'.._HOME..'/lexers/?.lua'
+
+-- Wraps the LPeg lexer module's `load()` function, once the LPeg lexer has
+-- loaded that module, so that a language's grammar and styles are compiled only
+-- once instead of for every buffer, and again only when its lexer file changes.
+-- Lexers that other lexers load (e.g. for embedding) are not cached since their
+-- parents modify them.
+local function cache_lexers()
+  local lexer = package.loaded.lexer
+  if not lexer or lexer == cached_lexer_module then return end
+  lexer_cache, cached_lexer_module = {}, lexer
+  local load, depth = lexer.load, 0
+  lexer.load = function(name, alt_name, ...)
+    if depth > 0 or alt_name then return load(name, alt_name, ...) end
+    local filename = package.searchpath(name, LEXERPATH)
+    local mtime = filename and lfs.attributes(filename, 'modification')
+    local cached = lexer_cache[name]
+    if cached and cached.mtime == mtime then
+      lexer.WHITESPACE = name..'_whitespace'
+      return cached.lexer
+    end
+    depth = depth + 1
+    local ok, result = pcall(load, name, alt_name, ...)
+    depth = depth - 1
+    if not ok then error(result, 0) end
+    lexer_cache[name] = {lexer = result, mtime = mtime}
+    return result
+  end
+end
+
 -- Sets default properties for a Scintilla document.
 events_connect(events.BUFFER_NEW, function()
   buffer.code_page = buffer.CP_UTF8
@@ -300,6 +335,7 @@ events_connect(events.BUFFER_NEW, function()
                                        _HOME..'/lexers'
   load_theme_and_settings()
   buffer:private_lexer_call(SETLEXERLANGUAGE, 'text')
+  cache_lexers()
 end)
 
 -- Switches between buffers when a tab is clicked.
@@ -351,6 +387,7 @@ events_connect(events.UPDATE_UI, function(updated)
   local tabs = string.format('%s %d', buffer.use_tabs and _L['Tabs:'] or
                                       _L['Spaces:'], buffer.tab_width)
   local enc = buffer.encoding or ''
+  if buffer.large_file then enc = enc..' '.._L['Large file'] end
   local text = not CURSES and '%s %d/%d    %s %d    %s    %s    %s    %s' or
                               '%s %d/%d  %s %d  %s  %s  %s  %s'
   ui.bufstatusbar_text = string.format(text, _L['Line:'], line, max, _L['Col:'],
@@ -360,12 +397,14 @@ end)
 -- Save buffer properties.
 events_connect(events.BUFFER_BEFORE_SWITCH, function()
   local buffer = buffer
+  if buffer._load then return end -- unloaded placeholder; nothing changed
   -- Save view state.
   buffer._anchor, buffer._current_pos = buffer.anchor, buffer.current_pos
   buffer._top_line = buffer:doc_line_from_visible(buffer.first_visible_line)
   buffer._x_offset = buffer.x_offset
   -- Save fold state.
   buffer._folds = {}
+  if buffer.large_file then return end -- folding is off
   local folds, i = buffer._folds, buffer:contracted_fold_next(0)
   while i >= 0 do
     folds[#folds + 1], i = i, buffer:contracted_fold_next(i + 1)
@@ -398,6 +437,7 @@ events_connect(events.VIEW_AFTER_SWITCH, update_bars)
 -- Save view state.
 local function save_view_state()
   local buffer = buffer
+  if buffer._load then return end -- unloaded placeholder
   buffer._view_eol, buffer._view_ws = buffer.view_eol, buffer.view_ws
   buffer._wrap_mode = buffer.wrap_mode
   buffer._margin_type_n, buffer._margin_width_n = {}, {}
@@ -430,7 +470,7 @@ events_connect(events.RESET_AFTER,
 events_connect(events.QUIT, function()
   local utf8_list = {}
   for i = 1, #_BUFFERS do
-    if _BUFFERS[i].modify then
+    if not _BUFFERS[i]._load and _BUFFERS[i].modify then
       local filename = _BUFFERS[i].filename or _BUFFERS[i]._type or
                        _L['Untitled']
       if _BUFFERS[i].filename then
@@ -13,4 +13,4 @@ package.cpath = table.concat({
 
 textadept = require('textadept')
 local user_init = _USERHOME..'/init.lua'
-if lfs.attributes(user_init) then dofile(user_init) end
+if lfs.attributes(user_init) then assert(loadfile(user_init))() end
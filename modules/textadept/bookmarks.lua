@@ -9,7 +9,11 @@ local M = {}
 --   The bookmark mark number.
 module('textadept.bookmarks')]]
 
-M.MARK_BOOKMARK = _SCINTILLA.next_marker_number()
+-- Reuse any marker number given to this module's placeholder (see
+-- textadept/init.lua), since marker numbers are limited.
+local placeholder = textadept and rawget(textadept, 'bookmarks') or {}
+M.MARK_BOOKMARK = rawget(placeholder, 'MARK_BOOKMARK') or
+                  _SCINTILLA.next_marker_number()
 
 ---
 -- Toggles the bookmark on line number *line* or the current line, unless *on*
@@ -9,7 +9,7 @@ local M = {}
 --   Match the previous line's indentation level after inserting a new line.
 --   The default value is `true`.
 -- @field strip_trailing_spaces (bool)
---   Strip trailing whitespace before saving files.
+--   Strip trailing whitespace before saving files, except for large files.
 --   The default value is `false`.
 -- @field autocomplete_all_words (bool)
 --   Autocomplete the current word using words from all open buffers.
@@ -206,7 +206,7 @@ end
 
 -- Prepares the buffer for saving to a file.
 events.connect(events.FILE_BEFORE_SAVE, function()
-  if not M.strip_trailing_spaces then return end
+  if not M.strip_trailing_spaces or buffer.large_file then return end
   local buffer = buffer
   buffer:begin_undo_action()
   -- Strip trailing whitespace.
@@ -429,8 +429,10 @@ end
 -- @name convert_indentation
 function M.convert_indentation()
   local buffer = buffer
-  buffer:begin_undo_action()
-  for line = 0, buffer.line_count - 1 do
+  -- Collect replacements from the last line to the first so that positions
+  -- remain valid, then make them all in a single batch.
+  local batch = {}
+  for line = buffer.line_count - 1, 0, -1 do
     local s = buffer:position_from_line(line)
     local indent = buffer.line_indentation[line]
     local e = buffer.line_indent_position[line]
@@ -444,11 +446,11 @@ function M.convert_indentation()
       new_indentation = string.rep(' ', indent)
     end
     if current_indentation ~= new_indentation then
-      buffer:set_target_range(s, e)
-      buffer:replace_target(new_indentation)
+      batch[#batch + 1] = {'set_target_range', s, e}
+      batch[#batch + 1] = {'replace_target', new_indentation}
     end
   end
-  buffer:end_undo_action()
+  buffer:batch(batch, true)
 end
 
 -- Clears highlighted word indicators and markers.
@@ -460,9 +462,27 @@ events.connect(events.KEYPRESS, function(code)
   if keys.KEYSYMS[code] == 'esc' then clear_highlighted_words() end
 end)
 
+-- Targets the text that searches for words in *buffer* should cover and returns
+-- the end of that text: the whole document, or just the lines on the screen for
+-- large files.
+-- @param buffer The buffer to target.
+local function target_word_search_range(buffer)
+  if not buffer.large_file then
+    buffer:target_whole_document()
+    return buffer.length
+  end
+  local first_line = buffer.first_visible_line
+  local s = buffer:position_from_line(buffer:doc_line_from_visible(first_line))
+  local last_line = first_line + buffer.lines_on_screen
+  local e = buffer.line_end_position[buffer:doc_line_from_visible(last_line)]
+  buffer:set_target_range(s, e)
+  return e
+end
+
 ---
 -- Highlights all occurrences of the selected text or all occurrences of the
 -- current word.
+-- In large files, only occurrences on the screen are highlighted.
 -- @see buffer.word_chars
 -- @name highlight_word
 function M.highlight_word()
@@ -476,11 +496,11 @@ function M.highlight_word()
   if s == e then return end
   local word = buffer:text_range(s, e)
   buffer.search_flags = buffer.FIND_WHOLEWORD + buffer.FIND_MATCHCASE
-  buffer:target_whole_document()
+  local search_end = target_word_search_range(buffer)
   while buffer:search_in_target(word) > -1 do
     buffer:indicator_fill_range(buffer.target_start,
                                 buffer.target_end - buffer.target_start)
-    buffer:set_target_range(buffer.target_end, buffer.length)
+    buffer:set_target_range(buffer.target_end, search_end)
   end
   buffer:set_sel(s, e)
 end
@@ -546,6 +566,8 @@ end
 -- Returns for the word behind the caret a list of completions constructed from
 -- the current buffer or all open buffers (depending on
 -- `M.autocomplete_all_words`).
+-- Only the lines on the screen of the current buffer are searched in large
+-- files, and other large buffers are not searched.
 -- @see buffer.word_chars
 -- @see autocomplete
 M.autocompleters.word = function()
@@ -554,20 +576,21 @@ M.autocompleters.word = function()
   if s == buffer.current_pos then return end
   local word = buffer:text_range(s, buffer.current_pos)
   for i = 1, #_BUFFERS do
-    if _BUFFERS[i] == buffer or M.autocomplete_all_words then
+    if _BUFFERS[i] == buffer or
+       M.autocomplete_all_words and not _BUFFERS[i].large_file then
       local buffer = _BUFFERS[i]
       buffer.search_flags = buffer.FIND_WORDSTART
       if not buffer.auto_c_ignore_case then
         buffer.search_flags = buffer.search_flags + buffer.FIND_MATCHCASE
       end
-      buffer:target_whole_document()
+      local search_end = target_word_search_range(buffer)
       while buffer:search_in_target(word) > -1 do
         local e = buffer:word_end_position(buffer.target_end, true)
         local match = buffer:text_range(buffer.target_start, e)
         if #match > #word and not matches[match] then
           list[#list + 1], matches[match] = match, true
         end
-        buffer:set_target_range(e, buffer.length)
+        buffer:set_target_range(e, search_end)
       end
     end
   end
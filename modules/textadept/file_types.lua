@@ -64,7 +64,9 @@ local SETDIRECTPOINTER = _SCINTILLA.properties.doc_pointer[2]
 local SETLEXERLANGUAGE = _SCINTILLA.properties.lexer_language[2]
 -- LuaDoc is in core/.buffer.luadoc.
 local function set_lexer(buffer, lang)
-  if not lang then lang = detect_language(buffer) end
+  if not lang then
+    lang = not buffer.large_file and detect_language(buffer) or 'text'
+  end
   buffer:private_lexer_call(SETDIRECTPOINTER, buffer.direct_pointer)
   buffer:private_lexer_call(SETLEXERLANGUAGE, lang)
   buffer._lexer = lang
@@ -245,42 +245,23 @@ function M.find_in_files(dir, filter)
   buffer.indicator_current = M.INDIC_FIND
   local ff_buffer = buffer
 
-  local buffer = buffer.new() -- temporary buffer
-  buffer.code_page = 0
-  local text, flags, found, ref_time = M.find_entry_text, 0, false, os.time()
+  -- Collect the files to search, then search them in parallel.
+  local files = {}
+  lfs.dir_foreach(dir, function(filename) files[#files + 1] = filename end,
+                  filter or M.find_in_files_filter)
+  local flags, found, ref_time = 0, false, os.time()
   if M.match_case then flags = flags + buffer.FIND_MATCHCASE end
   if M.whole_word then flags = flags + buffer.FIND_WHOLEWORD end
   if M.regex then flags = flags + buffer.FIND_REGEXP end
-  buffer.search_flags = flags
-  lfs.dir_foreach(dir, function(filename)
-    buffer:clear_all()
-    buffer:empty_undo_buffer()
-    local f = io.open(filename, 'rb')
-    while f:read(0) do buffer:append_text(f:read(1048576)) end
-    --buffer:set_text(f:read('*a'))
-    f:close()
-    local binary = nil -- determine lazily for performance reasons
-    buffer:target_whole_document()
-    while buffer:search_in_target(text) > -1 do
-      found = true
-      if binary == nil then binary = buffer:text_range(0, 65536):find('\0') end
-      local utf8_filename = filename:iconv('UTF-8', _CHARSET)
-      if not binary then
-        local line_num = buffer:line_from_position(buffer.target_start)
-        local line = buffer:get_line(line_num)
-        ff_buffer:append_text(string.format('%s:%d:%s', utf8_filename,
-                                            line_num + 1, line))
-        local pos = ff_buffer.length - #line +
-                    buffer.target_start - buffer:position_from_line(line_num)
-        ff_buffer:indicator_fill_range(pos,
-                                       buffer.target_end - buffer.target_start)
-        if not line:find('\n$') then ff_buffer:append_text('\n') end
-      else
-        ff_buffer:append_text(string.format('%s:1:%s\n', utf8_filename,
-                                            _L['Binary file matches.']))
-        break
+  M._search_files(files, M.find_entry_text, flags, _L['Binary file matches.'],
+                  function(text, ranges)
+    if text then
+      local pos = ff_buffer.length
+      ff_buffer:append_text(text)
+      for i = 1, #ranges, 2 do
+        ff_buffer:indicator_fill_range(pos + ranges[i], ranges[i + 1])
       end
-      buffer:set_target_range(buffer.target_end, buffer.length)
+      found = true
     end
     if os.difftime(os.time(), ref_time) >= M.find_in_files_timeout then
       local continue = ui.dialogs.yesno_msgbox{
@@ -294,9 +275,8 @@ function M.find_in_files(dir, filter)
       end
       ref_time = os.time()
     end
-  end, filter or M.find_in_files_filter)
+  end)
   if not found then ff_buffer:append_text(_L['No results found']) end
-  buffer:delete() -- delete temporary buffer
   ui._print(_L['[Files Found Buffer]'], '') -- goto end, set save pos, etc.
 end
 
@@ -9,12 +9,60 @@ textadept = M
 -- It provides utilities for editing text in Textadept.
 module('textadept')]]
 
-M.bookmarks = require('textadept.bookmarks')
+-- Modules that are not needed until first used, mapped to the names of their
+-- marker number fields, which themes need before then.
+-- Until a module is loaded, its field holds a placeholder table with those
+-- fields. Accessing or assigning any other field loads the module, as does
+-- idling after startup.
+local lazy_modules = {
+  bookmarks = {'MARK_BOOKMARK'}, run = {'MARK_WARNING', 'MARK_ERROR'}
+}
+
+-- Loads lazily loaded module *name*, replacing its placeholder table.
+-- The placeholder's fields are kept and any remaining references to the
+-- placeholder are forwarded to the module.
+-- @param name The name of the module to load.
+-- @return module
+local function load_module(name)
+  local placeholder = M[name]
+  local module = require('textadept.'..name)
+  for k, v in pairs(placeholder) do module[k] = v end
+  M[name] = module
+  setmetatable(placeholder, {__index = module, __newindex = module})
+  return module
+end
+
+for name, fields in pairs(lazy_modules) do
+  local placeholder = {}
+  for _, field in ipairs(fields) do
+    placeholder[field] = _SCINTILLA.next_marker_number()
+  end
+  M[name] = setmetatable(placeholder, {
+    __index = function(_, k) return load_module(name)[k] end,
+    __newindex = function(_, k, v) load_module(name)[k] = v end
+  })
+end
+
+-- Loads any lazily loaded modules not yet loaded.
+local function load_all()
+  for name in pairs(lazy_modules) do
+    if not package.loaded['textadept.'..name] then load_module(name) end
+  end
+end
+if CURSES then
+  local function load_when_idle()
+    load_all()
+    events.disconnect('idle', load_when_idle)
+  end
+  events.connect('idle', load_when_idle) -- undocumented, terminal-only event
+else
+  events.connect(events.INITIALIZED, function() timeout(1, load_all) end)
+end
+
 require('textadept.command_entry')
 M.editing = require('textadept.editing')
 M.file_types = require('textadept.file_types')
 require('textadept.find')
-M.run = require('textadept.run')
 M.session = require('textadept.session')
 M.snippets = require('textadept.snippets')
 
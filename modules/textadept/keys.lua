@@ -384,24 +384,26 @@ keys[not OSX and (GUI and 'ce' or 'mc')
              or 'me'] = m_tools[_L['Command _Entry']][2]
 keys[not OSX and (GUI and 'cE' or 'mC')
              or 'mE'] = m_tools[_L['Select Co_mmand']][2]
-keys[not OSX and 'cr' or 'mr'] = textadept.run.run
-keys[not OSX and (GUI and 'cR' or 'cmr') or 'mR'] = textadept.run.compile
-keys[not OSX and (GUI and 'cB' or 'cmb') or 'mB'] = textadept.run.build
+keys[not OSX and 'cr' or 'mr'] = m_tools[_L['_Run']][2]
+keys[not OSX and (GUI and 'cR' or 'cmr') or 'mR'] = m_tools[_L['_Compile']][2]
+keys[not OSX and (GUI and 'cB' or 'cmb') or 'mB'] = m_tools[_L['Buil_d']][2]
 if GUI then
   keys[not OSX and 'cA' or 'mA'] = m_tools[_L['Set _Arguments...']][2]
 end
-keys[not OSX and (GUI and 'cX' or 'cmx') or 'mX'] = textadept.run.stop
+keys[not OSX and (GUI and 'cX' or 'cmx') or 'mX'] = m_tools[_L['S_top']][2]
 keys[not OSX and (GUI and 'cae' or 'mx')
              or 'cme'] = m_tools[_L['_Next Error']][2]
 keys[not OSX and (GUI and 'caE' or 'mX')
              or 'cmE'] = m_tools[_L['_Previous Error']][2]
 -- Bookmark.
 local m_bookmark = m_tools[_L['_Bookmark']]
-keys[not OSX and (GUI and 'cf2' or 'f1') or 'mf2'] = textadept.bookmarks.toggle
-keys[not OSX and (GUI and 'csf2' or 'f6') or 'msf2'] = textadept.bookmarks.clear
+keys[not OSX and (GUI and 'cf2' or 'f1')
+             or 'mf2'] = m_bookmark[_L['_Toggle Bookmark']][2]
+keys[not OSX and (GUI and 'csf2' or 'f6')
+             or 'msf2'] = m_bookmark[_L['_Clear Bookmarks']][2]
 keys.f2 = m_bookmark[_L['_Next Bookmark']][2]
 keys[GUI and 'sf2' or 'f3'] = m_bookmark[_L['_Previous Bookmark']][2]
-keys[GUI and 'af2' or 'f4'] = textadept.bookmarks.goto_mark
+keys[GUI and 'af2' or 'f4'] = m_bookmark[_L['_Goto Bookmark...']][2]
 -- Quick Open.
 local m_quick_open = m_tools[_L['Quick _Open']]
 keys[not OSX and 'cu' or 'mu'] = m_quick_open[_L['Quickly Open _User Home']][2]
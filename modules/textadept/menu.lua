@@ -171,8 +171,8 @@ local default_menubar = {
     end},
     {_L['Select Co_mmand'], function() M.select_command() end},
     SEPARATOR,
-    {_L['_Run'], textadept.run.run},
-    {_L['_Compile'], textadept.run.compile},
+    {_L['_Run'], function() textadept.run.run() end},
+    {_L['_Compile'], function() textadept.run.compile() end},
     {_L['Set _Arguments...'], function()
       if not buffer.filename then return end
       local run_commands = textadept.run.run_commands
@@ -200,8 +200,8 @@ local default_menubar = {
                                     utf8_args[i]:iconv(_CHARSET, 'UTF-8')
       end
     end},
-    {_L['Buil_d'], textadept.run.build},
-    {_L['S_top'], textadept.run.stop},
+    {_L['Buil_d'], function() textadept.run.build() end},
+    {_L['S_top'], function() textadept.run.stop() end},
     {_L['_Next Error'], function() textadept.run.goto_error(false, true) end},
     {_L['_Previous Error'], function()
       textadept.run.goto_error(false, false)
@@ -209,15 +209,17 @@ local default_menubar = {
     SEPARATOR,
     {
       title = _L['_Bookmark'],
-      {_L['_Toggle Bookmark'], textadept.bookmarks.toggle},
-      {_L['_Clear Bookmarks'], textadept.bookmarks.clear},
+      {_L['_Toggle Bookmark'], function() textadept.bookmarks.toggle() end},
+      {_L['_Clear Bookmarks'], function() textadept.bookmarks.clear() end},
       {_L['_Next Bookmark'], function()
         textadept.bookmarks.goto_mark(true)
       end},
       {_L['_Previous Bookmark'], function()
         textadept.bookmarks.goto_mark(false)
       end},
-      {_L['_Goto Bookmark...'], textadept.bookmarks.goto_mark},
+      {_L['_Goto Bookmark...'], function()
+        textadept.bookmarks.goto_mark()
+      end},
     },
     {
       title = _L['Quick _Open'],
@@ -47,8 +47,13 @@ module('textadept.run')]]
 
 M.run_in_background = false
 
-M.MARK_WARNING = _SCINTILLA.next_marker_number()
-M.MARK_ERROR = _SCINTILLA.next_marker_number()
+-- Reuse any marker numbers given to this module's placeholder (see
+-- textadept/init.lua), since marker numbers are limited.
+local placeholder = textadept and rawget(textadept, 'run') or {}
+M.MARK_WARNING = rawget(placeholder, 'MARK_WARNING') or
+                 _SCINTILLA.next_marker_number()
+M.MARK_ERROR = rawget(placeholder, 'MARK_ERROR') or
+               _SCINTILLA.next_marker_number()
 
 -- Events.
 events.COMPILE_OUTPUT, events.RUN_OUTPUT = 'compile_output', 'run_output'
@@ -131,10 +136,19 @@ end
 -- Compiles or runs file *filename* based on a shell command in *commands*.
 -- @param filename The file to run.
 -- @param commands Either `compile_commands` or `run_commands`.
-local function compile_or_run(filename, commands)
-  if filename == buffer.filename then
+-- @param saved Whether or not the file has just been saved in the background.
+local function compile_or_run(filename, commands, saved)
+  if filename == buffer.filename and not saved then
     buffer:annotation_clear_all()
     io.save_file()
+    if buffer._saving then
+      -- Large files are saved in the background; wait until this one is.
+      local on_saved = buffer._on_saved
+      on_saved[#on_saved + 1] = function(saved)
+        if saved then compile_or_run(filename, commands, true) end
+      end
+      return
+    end
   end
   -- Determine the command.
   local ext = filename:match('[^/\\.]+$')
@@ -263,7 +277,9 @@ M.build_commands = {--[[Ant]]['build.xml']='ant',--[[Dockerfile]]Dockerfile='doc
 function M.build(root_directory)
   if not root_directory then root_directory = io.get_project_root() end
   if not root_directory then return end
-  for i = 1, #_BUFFERS do _BUFFERS[i]:annotation_clear_all() end
+  for i = 1, #_BUFFERS do
+    if not _BUFFERS[i]._load then _BUFFERS[i]:annotation_clear_all() end
+  end
   -- Determine command.
   local command = M.build_commands[root_directory]
   if not command then
@@ -24,11 +24,85 @@ M.default_session = _USERHOME..(not CURSES and '/session' or '/session_term')
 M.save_on_quit = true
 M.max_recent_files = 10
 
+-- Fills session placeholder buffer *buffer* with the contents of its file and
+-- restores its bookmarks.
+-- Textadept calls this function the first time *buffer* is used with
+-- Scintilla, usually when it is first shown in a view, so loading a large
+-- session only reads the files that are visible.
+-- If the file cannot be loaded, the buffer is left without a filename so that
+-- saving it cannot overwrite the file with nothing.
+-- @param buffer The placeholder buffer to load.
+local function load_placeholder(buffer)
+  local filename = buffer.filename
+  buffer.filename = nil
+  io._load_file(buffer, filename)
+  buffer.filename = filename
+  buffer.mod_time = lfs.attributes(filename, 'modification') or os.time()
+  buffer:set_save_point()
+  for i = 1, #buffer._bookmarks do
+    buffer:marker_add(buffer._bookmarks[i], textadept.bookmarks.MARK_BOOKMARK)
+  end
+  buffer._bookmarks = nil
+  if buffer ~= _G.buffer then
+    buffer._file_opened = false -- emit FILE_OPENED when switched to
+    return
+  end
+  -- Restore saved buffer selection and view since the buffer may never have
+  -- been switched to.
+  buffer:set_sel(buffer._anchor, buffer._current_pos)
+  buffer:line_scroll(0, buffer:visible_from_doc_line(buffer._top_line) -
+                        buffer.first_visible_line)
+  events.emit(events.FILE_OPENED, buffer.filename)
+end
+
+-- Emits the `FILE_OPENED` event of a placeholder buffer that was loaded while
+-- not being the current buffer.
+local function emit_file_opened()
+  if buffer._file_opened ~= false then return end
+  buffer._file_opened = nil
+  events.emit(events.FILE_OPENED, buffer.filename)
+end
+events.connect(events.BUFFER_AFTER_SWITCH, emit_file_opened)
+events.connect(events.VIEW_AFTER_SWITCH, emit_file_opened)
+
+-- Opens file *filename* as an empty placeholder buffer whose contents are not
+-- read until the buffer is first used, and returns that buffer.
+-- The placeholder keeps the given selection and top line, and any bookmarks
+-- added to its `_bookmarks` table, until then.
+-- @param filename The absolute path of the file to open.
+-- @param anchor The saved anchor position.
+-- @param current_pos The saved caret position.
+-- @param top_line The saved first visible line.
+-- @return buffer
+local function open_placeholder(filename, anchor, current_pos, top_line)
+  -- Reuse the initial "Untitled" buffer instead of creating another buffer and
+  -- closing it, since closing it would switch to (and load) the placeholder.
+  local buf = _BUFFERS[1]
+  local untitled = #_BUFFERS == 1 and
+                   not (buf.filename or buf._type or buf.modify)
+  local buffer = untitled and buf or buffer.new()
+  buffer.filename = filename
+  buffer._anchor, buffer._current_pos = anchor, current_pos
+  buffer._top_line, buffer._folds, buffer._bookmarks = top_line, {}, {}
+  buffer.tab_label = filename:iconv('UTF-8', _CHARSET):match('[^/\\]+$')
+  -- Add file to recent files list, eliminating duplicates.
+  table.insert(io.recent_files, 1, filename)
+  for i = 2, #io.recent_files do
+    if io.recent_files[i] == filename then
+      table.remove(io.recent_files, i)
+      break
+    end
+  end
+  buffer._load = load_placeholder
+  return buffer
+end
+
 ---
 -- Loads session file *filename* or the user-selected session, returning `true`
 -- if a session file was opened and read.
 -- Textadept restores split views, opened buffers, cursor information, recent
--- files, and bookmarks.
+-- files, and bookmarks. Opened buffers' files are not read until those buffers
+-- are first shown or otherwise used.
 -- @param filename Optional absolute path to the session file to load. If `nil`,
 --   the user is prompted for one.
 -- @return `true` if the session file was opened and read; `false` otherwise.
@@ -50,24 +124,31 @@ function M.load(filename)
     if line:find('^buffer:') then
       local patt = '^buffer: (%d+) (%d+) (%d+) (.+)$'
       local anchor, current_pos, top_line, filename = line:match(patt)
+      anchor, current_pos = tonumber(anchor), tonumber(current_pos)
+      top_line = tonumber(top_line)
       if not filename:find('^%[.+%]$') then
         if lfs.attributes(filename) then
-          io.open_file(filename)
+          -- Defer reading the file until its buffer is used.
+          open_placeholder(filename, anchor, current_pos, top_line)
         else
           not_found[#not_found + 1] = filename
         end
       else
         buffer.new()._type = filename
         events.emit(events.FILE_OPENED, filename) -- close initial untitled buf
+        -- Restore saved buffer selection and view.
+        buffer:set_sel(anchor, current_pos)
+        buffer:line_scroll(0, buffer:visible_from_doc_line(top_line) -
+                              buffer.first_visible_line)
       end
-      -- Restore saved buffer selection and view.
-      buffer:set_sel(tonumber(anchor), tonumber(current_pos))
-      buffer:line_scroll(0, buffer:visible_from_doc_line(tonumber(top_line)) -
-                            buffer.first_visible_line)
     elseif line:find('^bookmarks:') then
       local lines = line:match('^bookmarks: (.*)$')
       for line in lines:gmatch('%d+') do
-        buffer:marker_add(tonumber(line), textadept.bookmarks.MARK_BOOKMARK)
+        if buffer._load then
+          buffer._bookmarks[#buffer._bookmarks + 1] = tonumber(line)
+        else
+          buffer:marker_add(tonumber(line), textadept.bookmarks.MARK_BOOKMARK)
+        end
       end
     elseif line:find('^size:') then
       local maximized, width, height = line:match('^size: (%l+) (%d+) (%d+)$')
@@ -141,12 +222,13 @@ function M.save(filename)
                                                  buffer[current_pos] or 0,
                                                  buffer[top_line] or 0,
                                                  filename)
-      -- Write out bookmarks.
-      local lines = {}
-      local line = buffer:marker_next(0, 2^textadept.bookmarks.MARK_BOOKMARK)
+      -- Write out bookmarks. Unloaded placeholders still have the loaded ones.
+      local lines = buffer._load and buffer._bookmarks or {}
+      local mask = 2^textadept.bookmarks.MARK_BOOKMARK
+      local line = not buffer._load and buffer:marker_next(0, mask) or -1
       while line >= 0 do
         lines[#lines + 1] = line
-        line = buffer:marker_next(line + 1, 2^textadept.bookmarks.MARK_BOOKMARK)
+        line = buffer:marker_next(line + 1, mask)
       end
       session[#session + 1] = 'bookmarks: '..table.concat(lines, ' ')
     end
@@ -0,0 +1,50 @@
+-- Copyright 2007-2016 Mitchell mitchell.att.foicica.com. See LICENSE.
+
+-- Micro-benchmark for buffer function, property, and constant dispatch.
+-- Run from within Textadept so the results reflect the C dispatch layer:
+--   textadept -n -f -e "dofile(_HOME..'/scripts/bench_dispatch.lua')"
+-- Results are printed to stdout in calls per second. Compare the output of
+-- builds before and after a dispatch change on the same machine, running both
+-- the GTK and the terminal version (`textadept-curses`), since they send
+-- Scintilla messages differently.
+
+local N = tonumber(os.getenv('BENCH_N')) or 1000000
+
+buffer:set_text(string.rep('local x = 1\n', 1000))
+
+local function bench(name, f)
+  f(1000) -- warm up
+  local start = os.clock()
+  f(N)
+  local elapsed = os.clock() - start
+  print(string.format('%-40s %14.0f calls/s', name, N / elapsed))
+end
+
+bench('buffer:line_from_position()', function(n)
+  local buffer = buffer
+  for i = 1, n do buffer:line_from_position(i % 10000) end
+end)
+bench('buffer.length', function(n)
+  local buffer = buffer
+  for i = 1, n do local _ = buffer.length end
+end)
+bench('buffer.line_end_position[]', function(n)
+  local buffer = buffer
+  for i = 1, n do local _ = buffer.line_end_position[i % 1000] end
+end)
+bench('buffer.FIND_MATCHCASE', function(n)
+  local buffer = buffer
+  for i = 1, n do local _ = buffer.FIND_MATCHCASE end
+end)
+bench('non-focused buffer:line_from_position()', function(n)
+  local buffer = buffer.new()
+  buffer:set_text(string.rep('local x = 1\n', 1000))
+  view:goto_buffer(_BUFFERS[1])
+  for i = 1, n do buffer:line_from_position(i % 10000) end
+  buffer:set_save_point()
+  view:goto_buffer(buffer)
+  buffer:close(true)
+end)
+
+buffer:set_save_point()
+quit()
@@ -0,0 +1,180 @@
+// Copyright 2007-2016 Mitchell mitchell.att.foicica.com. See LICENSE.
+
+// Startup and keypress latency benchmark for the terminal version of Textadept.
+// Runs textadept-curses under a pseudo-terminal with a scratch `_USERHOME`
+// whose *init.lua* records when the `initialized` event is emitted. Measures
+// the time from exec() to that event and to the first screen update after it,
+// then types canned keystrokes (which libtermkey reads from the terminal like
+// real input) and measures the time until the screen is updated in response to
+// each one. No X server is needed.
+// The same `_USERHOME` is used for all runs, so the first run is a cold start
+// and the rest are warm starts.
+// Results are printed to stdout as JSON with times in milliseconds; a `null`
+// time means Textadept did not respond within the timeout.
+// Usage: bench_startup path/to/textadept-curses [runs]
+// This is normally run via `make bench-startup` from *src/*.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#if __linux__
+#include <pty.h>
+#else
+#include <util.h>
+#endif
+
+#define STARTUP_TIMEOUT 10000 // ms
+#define KEY_TIMEOUT 2000 // ms
+#define QUIET 200 // ms without output before the screen is considered updated
+#define MAX_CHUNKS 65536
+
+static const char *init_lua =
+  "events.connect(events.INITIALIZED, function()\n"
+  "  local f = io.open(_USERHOME..'/initialized', 'wb')\n"
+  "  f:write(string.format('%.0f', trace.clock()))\n"
+  "  f:close()\n"
+  "end)\n";
+
+// Canned keystrokes as terminal input sequences.
+static const struct { const char *name, *seq; } keys[] = {
+  {"h", "h"}, {"e", "e"}, {"l", "l"}, {"l", "l"}, {"o", "o"},
+  {"Enter", "\r"}, {"Up", "\033[A"}, {"End", "\033[F"}, {"Down", "\033[B"},
+  {"Home", "\033[H"}, {"BackSpace", "\177"}, {"Enter", "\r"}
+};
+
+static char userhome[] = "/tmp/textadept_bench_XXXXXX";
+static char initialized_file[sizeof(userhome) + 16];
+static long long chunks[MAX_CHUNKS]; // times at which output was read
+static int num_chunks;
+
+/**
+ * Returns the current value of the monotonic clock Textadept's `trace.clock()`
+ * uses, in nanoseconds.
+ */
+static long long nanotime() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Reads and discards output from the pseudo-terminal until there has been none
+ * for `quiet` milliseconds or until `timeout` milliseconds have passed,
+ * recording the time each chunk was read.
+ * @param fd The pseudo-terminal master's file descriptor.
+ * @param quiet Number of milliseconds without output to wait for.
+ * @param timeout Maximum number of milliseconds to read for.
+ * @return the time the first chunk was read, or `0` if there was no output
+ */
+static long long drain(int fd, int quiet, int timeout) {
+  char buf[BUFSIZ];
+  long long start = nanotime(), last = start, first = 0;
+  struct pollfd pfd = {fd, POLLIN, 0};
+  while ((nanotime() - start) / 1000000 < timeout) {
+    if (poll(&pfd, 1, 10) > 0) {
+      if (read(fd, buf, sizeof(buf)) <= 0) break; // child exited
+      last = nanotime();
+      if (!first) first = last;
+      if (num_chunks < MAX_CHUNKS) chunks[num_chunks++] = last;
+    } else if (first && (nanotime() - last) / 1000000 >= quiet) break;
+  }
+  return first;
+}
+
+/**
+ * Returns the time the `initialized` event was emitted, or `0` if it has not
+ * been emitted yet.
+ */
+static long long initialized() {
+  FILE *f = fopen(initialized_file, "rb");
+  if (!f) return 0;
+  long long time = 0;
+  if (fscanf(f, "%lld", &time) != 1) time = 0;
+  return (fclose(f), time);
+}
+
+/** Prints the given number of nanoseconds in milliseconds, or `null`. */
+static void print_ms(long long ns) {
+  if (ns > 0) printf("%.3f", ns / 1e6); else printf("null");
+}
+
+/**
+ * Runs Textadept once and prints that run's results as a JSON object.
+ * @param textadept The path to textadept-curses.
+ */
+static void run(const char *textadept) {
+  struct winsize size = {24, 80, 0, 0};
+  int fd;
+  unlink(initialized_file), num_chunks = 0;
+  long long exec_time = nanotime();
+  pid_t pid = forkpty(&fd, NULL, NULL, &size);
+  if (pid < 0) perror("forkpty"), exit(1);
+  if (pid == 0) {
+    setenv("TERM", "xterm", 1);
+    execl(textadept, textadept, "-n", "-u", userhome, (char *)NULL);
+    perror(textadept), _exit(127);
+  }
+
+  // Startup. Wait for the `initialized` event and for the screen updates that
+  // follow it to finish.
+  while (drain(fd, QUIET, QUIET) || !initialized())
+    if ((nanotime() - exec_time) / 1000000 > STARTUP_TIMEOUT) break;
+  long long init_time = initialized(), paint_time = 0;
+  for (int i = 0; i < num_chunks && init_time; i++)
+    if (chunks[i] >= init_time) {
+      paint_time = chunks[i];
+      break;
+    }
+  printf("    {\"initialized_ms\": ");
+  print_ms(init_time ? init_time - exec_time : 0);
+  printf(", \"first_paint_ms\": ");
+  print_ms(paint_time ? paint_time - exec_time : 0);
+
+  // Keystrokes.
+  printf(",\n     \"keys\": [");
+  for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+    long long sent = nanotime();
+    if (write(fd, keys[i].seq, strlen(keys[i].seq)) < 0) break;
+    long long response = drain(fd, QUIET, KEY_TIMEOUT);
+    printf("%s\n       {\"key\": \"%s\", \"latency_ms\": ", i ? "," : "",
+           keys[i].name);
+    print_ms(response ? response - sent : 0);
+    printf("}");
+  }
+  printf("\n     ]}");
+
+  kill(pid, SIGTERM), waitpid(pid, NULL, 0), close(fd);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s path/to/textadept-curses [runs]\n", argv[0]);
+    return 1;
+  }
+  int runs = argc > 2 ? atoi(argv[2]) : 5;
+  if (!mkdtemp(userhome)) return (perror("mkdtemp"), 1);
+  char init_file[sizeof(userhome) + 16];
+  sprintf(init_file, "%s/init.lua", userhome);
+  sprintf(initialized_file, "%s/initialized", userhome);
+  FILE *f = fopen(init_file, "wb");
+  if (!f) return (perror(init_file), 1);
+  fputs(init_lua, f), fclose(f);
+
+  printf("{\"textadept\": \"%s\", \"runs\": [\n", argv[1]);
+  for (int i = 0; i < runs; i++) {
+    if (i > 0) printf(",\n");
+    run(argv[1]), fflush(stdout);
+  }
+  printf("\n]}\n");
+
+  char command[sizeof(userhome) + 16];
+  sprintf(command, "rm -rf %s", userhome);
+  return system(command) == 0 ? 0 : 1;
+}
@@ -21,6 +21,82 @@ local ignores = { -- constants to ignore
 local changed_setter = {} -- holds properties changed to setter functions
 local string_format, table_unpack = string.format, table.unpack
 
+-- Returns the seeded 32-bit FNV-1a hash of string *s*.
+-- This must match `iface_hash()` in src/textadept.c.
+local function hash(s, seed)
+  local h = seed ~= 0 and seed or 0x811C9DC5
+  for i = 1, #s do h = ((h ~ s:byte(i)) * 0x01000193) & 0xFFFFFFFF end
+  return h
+end
+
+-- Computes a minimal perfect hash of the list of *names* and returns the names
+-- ordered by hash slot along with the list of bucket seeds.
+-- Names are grouped into buckets by their unseeded hash. Starting with the
+-- largest bucket, each multi-name bucket is given the first seed that hashes
+-- all of its names into free slots, and each single-name bucket is given a
+-- free slot directly, stored as the negative seed `-slot - 1`.
+local function perfect_hash(names)
+  local n, buckets, seeds, slots, free = #names, {}, {}, {}, 1
+  for i = 1, n do buckets[i], seeds[i] = {index = i}, 0 end
+  for i = 1, n do
+    local bucket = buckets[hash(names[i], 0) % n + 1]
+    bucket[#bucket + 1] = names[i]
+  end
+  table.sort(buckets, function(a, b)
+    if #a ~= #b then return #a > #b end
+    return a.index < b.index
+  end)
+  for i = 1, n do
+    local bucket = buckets[i]
+    if #bucket > 1 then
+      local seed, placed, j = 1, {}, 1
+      while j <= #bucket do
+        local slot = hash(bucket[j], seed) % n + 1
+        if slots[slot] or placed[slot] then
+          seed, placed, j = seed + 1, {}, 1 -- collision; try the next seed
+        else
+          placed[slot], j = bucket[j], j + 1
+        end
+      end
+      for slot, name in pairs(placed) do slots[slot] = name end
+      seeds[bucket.index] = seed
+    elseif #bucket == 1 then
+      while slots[free] do free = free + 1 end
+      slots[free], seeds[bucket.index] = bucket[1], -free
+    end
+  end
+  return slots, seeds
+end
+
+-- Writes to file *f* the C perfect hash table *name* of the interface entries
+-- in map *t*, whose values are lists of *fields* integers.
+local function write_c_table(f, name, t, fields)
+  local slots, seeds = perfect_hash(t)
+  f:write(string_format('static const IfaceEntry iface_%s_entries[] = {\n',
+                        name))
+  for i = 1, #slots do
+    local values = {table_unpack(t[slots[i]], 1, fields)}
+    f:write(string_format('  {"%s", {%s}},\n', slots[i],
+                          table.concat(values, ', ')))
+  end
+  f:write('};\n')
+  f:write(string_format('static const int iface_%s_seeds[] = {', name))
+  local line = 80
+  for i = 1, #seeds do
+    local seed = tostring(seeds[i])..(i < #seeds and ',' or '')
+    if line + #seed + 1 > 80 then
+      f:write('\n ')
+      line = 1
+    end
+    f:write(' ', seed)
+    line = line + #seed + 1
+  end
+  f:write('\n};\n')
+  f:write(string_format('static const IfaceTable iface_%s = {\n', name))
+  f:write(string_format('  iface_%s_entries, iface_%s_seeds, %d, %d\n};\n',
+                        name, name, #slots, fields))
+end
+
 for line in io.lines('../src/scintilla/include/Scintilla.iface') do
   if line:find('^val ') then
     local name, value = line:match(const_patt)
@@ -87,7 +163,42 @@ table.sort(constants)
 table.sort(functions)
 table.sort(properties)
 
-local f = io.open('../core/iface.lua', 'wb')
+-- Split constants into names and values for the C tables.
+local constant_values = {}
+for i = 1, #constants do
+  local name, value = constants[i]:match('^([^=]+)=(.+)$')
+  constant_values[#constant_values + 1] = name
+  constant_values[name] = {value}
+end
+
+local f = io.open('../src/iface.h', 'wb')
+f:write([[
+// Copyright 2007-2016 Mitchell mitchell.att.foicica.com. See LICENSE.
+// This file is generated by scripts/gen_iface.lua. Do not modify it.
+
+// Scintilla constants, functions, and properties as static perfect hash tables.
+// Function values are IDs, return types, wParam types, and lParam types.
+// Property values are "get" IDs, "set" IDs, return types, and wParam types.
+// Constant values are numeric values.
+typedef struct {
+  const char *name;
+  int values[4];
+} IfaceEntry;
+typedef struct {
+  const IfaceEntry *entries;
+  const int *seeds; // per-bucket seeds, or `-slot - 1` for single-name buckets
+  int size, fields;
+} IfaceTable;
+
+]])
+write_c_table(f, 'constants', constant_values, 1)
+f:write('\n')
+write_c_table(f, 'functions', functions, 4)
+f:write('\n')
+write_c_table(f, 'properties', properties, 4)
+f:close()
+
+f = io.open('../core/iface.lua', 'wb')
 f:write([=[
 -- Copyright 2007-2016 Mitchell mitchell.att.foicica.com. See LICENSE.
 
@@ -100,6 +211,10 @@ local M = {}
 -- consequences.
 module('_SCINTILLA')]]
 
+-- The constants, functions, and properties tables are provided by Textadept as
+-- views of the interface tables compiled into it from src/iface.h. Entries are
+-- created when first accessed.
+
 ]=])
 f:write([[
 ---
@@ -107,10 +222,8 @@ f:write([[
 -- @class table
 -- @name constants
 -- @see _G.buffer
-M.constants = {]])
-f:write(table.concat(constants, ','))
-f:write('}\n\n')
-f:write([[
+M.constants = _SCINTILLA.constants
+
 ---
 -- Map of Scintilla function names to tables containing their IDs, return types,
 -- wParam types, and lParam types. Types are as follows:
@@ -126,13 +239,8 @@ f:write([[
 --   + `8`: String return value.
 -- @class table
 -- @name functions
-M.functions = {]])
-for i = 1, #functions do
-  f:write(string_format('%s={%d,%d,%d,%d},', functions[i],
-                        table_unpack(functions[functions[i]])))
-end
-f:write('}\n\n')
-f:write([[
+M.functions = _SCINTILLA.functions
+
 ---
 -- Map of Scintilla property names to table values containing their "get"
 -- function IDs, "set" function IDs, return types, and wParam types.
@@ -141,13 +249,8 @@ f:write([[
 -- @see functions
 -- @class table
 -- @name properties
-M.properties = {]])
-for i = 1, #properties do
-  f:write(string_format('%s={%d,%d,%d,%d},', properties[i],
-                        table_unpack(properties[properties[i]])))
-end
-f:write('}\n\n')
-f:write([[
+M.properties = _SCINTILLA.properties
+
 local marker_number, indic_number, list_type, image_type = -1, -1, 0, 0
 
 ---
@@ -0,0 +1,844 @@
+// Copyright 2007-2016 Mitchell mitchell.att.foicica.com. See LICENSE.
+// This file is generated by scripts/gen_iface.lua. Do not modify it.
+
+// Scintilla constants, functions, and properties as static perfect hash tables.
+// Function values are IDs, return types, wParam types, and lParam types.
+// Property values are "get" IDs, "set" IDs, return types, and wParam types.
+// Constant values are numeric values.
+typedef struct {
+  const char *name;
+  int values[4];
+} IfaceEntry;
+typedef struct {
+  const IfaceEntry *entries;
+  const int *seeds; // per-bucket seeds, or `-slot - 1` for single-name buckets
+  int size, fields;
+} IfaceTable;
+
+static const IfaceEntry iface_constants_entries[] = {
+  {"SCN_HOTSPOTRELEASECLICK", {2027}},
+  {"IV_LOOKFORWARD", {2}},
+  {"INDIC_DOTS", {10}},
+  {"MARK_CIRCLE", {0}},
+  {"MAX_MARGIN", {4}},
+  {"SCN_DOUBLECLICK", {2006}},
+  {"UPDATE_CONTENT", {0x1}},
+  {"MARKNUM_FOLDER", {30}},
+  {"MARK_CIRCLEMINUS", {20}},
+  {"MOD_SHIFT", {1}},
+  {"CARET_STRICT", {0x04}},
+  {"MARGINOPTION_SUBLINESELECT", {1}},
+  {"INDIC_DIAGONAL", {3}},
+  {"STYLE_CALLTIP", {38}},
+  {"INDIC_CONTAINER", {8}},
+  {"SCN_INDICATORCLICK", {2023}},
+  {"SCN_CALLTIPCLICK", {2021}},
+  {"MARKNUM_FOLDEROPEN", {31}},
+  {"SCN_STYLENEEDED", {2000}},
+  {"SEL_LINES", {2}},
+  {"CURSORNORMAL", {-1}},
+  {"FOLDACTION_CONTRACT", {0}},
+  {"SCN_FOCUSOUT", {2029}},
+  {"ORDER_CUSTOM", {2}},
+  {"TIME_FOREVER", {10000000}},
+  {"INDIC_SQUIGGLELOW", {11}},
+  {"IDLESTYLING_ALL", {3}},
+  {"MARK_UNDERLINE", {29}},
+  {"CURSORREVERSEARROW", {7}},
+  {"WRAPINDENT_FIXED", {0}},
+  {"MOD_INSERTTEXT", {0x1}},
+  {"VS_USERACCESSIBLE", {2}},
+  {"INDIC_DOTBOX", {12}},
+  {"SCN_INDICATORRELEASE", {2024}},
+  {"MULTIAUTOC_EACH", {1}},
+  {"CARETSTICKY_ON", {1}},
+  {"MARK_BOXMINUS", {14}},
+  {"WRAPINDENT_SAME", {1}},
+  {"SCN_MACRORECORD", {2009}},
+  {"SCN_AUTOCSELECTION", {2022}},
+  {"UPDATE_H_SCROLL", {0x8}},
+  {"INDIC_TT", {2}},
+  {"MARK_CIRCLEPLUS", {18}},
+  {"WRAPVISUALFLAG_MARGIN", {0x0004}},
+  {"INDIC_COMPOSITIONTHIN", {15}},
+  {"SCN_NEEDSHOWN", {2011}},
+  {"MOD_CHANGEFOLD", {0x8}},
+  {"MARK_ARROW", {2}},
+  {"SCN_DWELLSTART", {2016}},
+  {"SCN_HOTSPOTCLICK", {2019}},
+  {"MOD_CONTAINER", {0x40000}},
+  {"INDIC_IME_MAX", {35}},
+  {"FOLDFLAG_LINEBEFORE_CONTRACTED", {0x0004}},
+  {"UPDATE_SELECTION", {0x2}},
+  {"MARKNUM_FOLDEREND", {25}},
+  {"MARK_PIXMAP", {25}},
+  {"FOLDFLAG_LINESTATE", {0x0080}},
+  {"MARGIN_NUMBER", {1}},
+  {"SCN_KEY", {2005}},
+  {"INDIC_MAX", {35}},
+  {"INDIC_SQUIGGLE", {1}},
+  {"AUTOMATICFOLD_CLICK", {0x0002}},
+  {"INDIC_SQUIGGLEPIXMAP", {13}},
+  {"MARK_BOOKMARK", {31}},
+  {"EDGE_NONE", {0}},
+  {"MARK_MINUS", {7}},
+  {"IME_WINDOWED", {0}},
+  {"MARK_ARROWDOWN", {6}},
+  {"WRAP_WHITESPACE", {3}},
+  {"WRAPVISUALFLAGLOC_START_BY_TEXT", {0x0002}},
+  {"MARK_CIRCLEMINUSCONNECTED", {21}},
+  {"WRAPVISUALFLAG_END", {0x0001}},
+  {"MARKNUM_FOLDEROPENMID", {26}},
+  {"VISIBLE_STRICT", {0x04}},
+  {"MARK_BOXMINUSCONNECTED", {15}},
+  {"CARETSTYLE_INVISIBLE", {0}},
+  {"INDIC_FULLBOX", {16}},
+  {"SCN_CHARADDED", {2001}},
+  {"INDIC_ROUNDBOX", {7}},
+  {"IDLESTYLING_AFTERVISIBLE", {2}},
+  {"FIND_REGEXP", {6291456}},
+  {"FOLDLEVELNUMBERMASK", {0x0FFF}},
+  {"CARET_EVEN", {0x08}},
+  {"FIND_CXX11REGEX", {0x00800000}},
+  {"MOD_LEXERSTATE", {0x80000}},
+  {"SCN_DWELLEND", {2017}},
+  {"INDIC_STRAIGHTBOX", {8}},
+  {"INDIC_IME", {32}},
+  {"MARGIN_RTEXT", {5}},
+  {"ORDER_PRESORTED", {0}},
+  {"MARKER_MAX", {31}},
+  {"WRAPVISUALFLAG_START", {0x0002}},
+  {"MARK_AVAILABLE", {28}},
+  {"STYLE_CONTROLCHAR", {36}},
+  {"ALPHA_TRANSPARENT", {0}},
+  {"SCN_HOTSPOTDOUBLECLICK", {2020}},
+  {"MOD_CHANGEMARGIN", {0x10000}},
+  {"LASTSTEPINUNDOREDO", {0x100}},
+  {"FIND_WHOLEWORD", {0x2}},
+  {"MOD_CHANGEINDICATOR", {0x4000}},
+  {"EOL_CR", {1}},
+  {"AUTOMATICFOLD_SHOW", {0x0001}},
+  {"MARGIN_SYMBOL", {0}},
+  {"MARK_BACKGROUND", {22}},
+  {"WRAPVISUALFLAGLOC_DEFAULT", {0x0000}},
+  {"MARK_ARROWS", {24}},
+  {"CASE_CAMEL", {3}},
+  {"EDGE_BACKGROUND", {2}},
+  {"MOUSE_RELEASE", {3}},
+  {"ALPHA_NOALPHA", {256}},
+  {"CARETSTYLE_BLOCK", {2}},
+  {"PERFORMED_REDO", {0x40}},
+  {"FOLDACTION_TOGGLE", {2}},
+  {"MARK_ROUNDRECT", {1}},
+  {"IV_LOOKBOTH", {3}},
+  {"STYLE_LINENUMBER", {33}},
+  {"MARKNUM_FOLDERTAIL", {28}},
+  {"MOD_CHANGESTYLE", {0x4}},
+  {"MOD_DELETETEXT", {0x2}},
+  {"SCN_SAVEPOINTREACHED", {2002}},
+  {"CURSORARROW", {2}},
+  {"ALPHA_OPAQUE", {255}},
+  {"MARK_EMPTY", {5}},
+  {"INDIC_PLAIN", {0}},
+  {"PERFORMED_UNDO", {0x20}},
+  {"CARETSTYLE_LINE", {1}},
+  {"CASEINSENSITIVEBEHAVIOUR_RESPECTCASE", {0}},
+  {"MOD_META", {16}},
+  {"INDIC_COMPOSITIONTHICK", {14}},
+  {"MOD_NORM", {0}},
+  {"INDIC_TEXTFORE", {17}},
+  {"WRAPVISUALFLAGLOC_END_BY_TEXT", {0x0001}},
+  {"VS_NONE", {0}},
+  {"MARK_SHORTARROW", {4}},
+  {"STYLE_BRACEBAD", {35}},
+  {"STYLE_LASTPREDEFINED", {39}},
+  {"SCN_SAVEPOINTLEFT", {2003}},
+  {"EOL_LF", {2}},
+  {"IME_INLINE", {1}},
+  {"ANNOTATION_INDENTED", {3}},
+  {"MARK_PLUS", {8}},
+  {"WS_INVISIBLE", {0}},
+  {"SCN_UPDATEUI", {2007}},
+  {"EDGE_LINE", {1}},
+  {"CP_UTF8", {65001}},
+  {"CARET_SLOP", {0x01}},
+  {"INDIC_STRIKE", {4}},
+  {"WS_VISIBLEALWAYS", {1}},
+  {"SCN_USERLISTSELECTION", {2014}},
+  {"MOD_BEFOREINSERT", {0x400}},
+  {"INDIC_BOX", {6}},
+  {"FIND_WORDSTART", {0x00100000}},
+  {"IDLESTYLING_TOVISIBLE", {1}},
+  {"SCN_AUTOCCHARDELETED", {2026}},
+  {"MOD_CHANGEMARKER", {0x200}},
+  {"WRAP_NONE", {0}},
+  {"FOLDLEVELWHITEFLAG", {0x1000}},
+  {"SCN_URIDROPPED", {2015}},
+  {"MARK_DOTDOTDOT", {23}},
+  {"MULTIPASTE_ONCE", {0}},
+  {"PERFORMED_USER", {0x10}},
+  {"MARK_RGBAIMAGE", {30}},
+  {"FOLDLEVELBASE", {0x400}},
+  {"MARGIN_BACK", {2}},
+  {"INDIC_DASH", {9}},
+  {"MOD_ALT", {4}},
+  {"CARETSTICKY_WHITESPACE", {2}},
+  {"STYLE_MAX", {255}},
+  {"MULTIAUTOC_ONCE", {0}},
+  {"SCN_MODIFYATTEMPTRO", {2004}},
+  {"SEL_RECTANGLE", {1}},
+  {"STYLE_INDENTGUIDE", {37}},
+  {"SCN_AUTOCCANCELLED", {2025}},
+  {"CARETSTICKY_OFF", {0}},
+  {"SCN_AUTOCCOMPLETED", {2030}},
+  {"MOD_CHANGELINESTATE", {0x8000}},
+  {"MARK_LCORNERCURVE", {16}},
+  {"STARTACTION", {0x2000}},
+  {"SCN_MARGINCLICK", {2010}},
+  {"FOLDLEVELHEADERFLAG", {0x2000}},
+  {"WRAPINDENT_INDENT", {2}},
+  {"CASE_LOWER", {2}},
+  {"WRAP_WORD", {1}},
+  {"MARK_TCORNER", {11}},
+  {"MOD_BEFOREDELETE", {0x800}},
+  {"MARK_TCORNERCURVE", {17}},
+  {"WS_VISIBLEONLYININDENT", {3}},
+  {"UPDATE_V_SCROLL", {0x4}},
+  {"MARK_VLINE", {9}},
+  {"MARGIN_TEXT", {4}},
+  {"VISIBLE_SLOP", {0x01}},
+  {"MARK_CIRCLEPLUSCONNECTED", {19}},
+  {"AUTOMATICFOLD_CHANGE", {0x0004}},
+  {"FOLDFLAG_LINEAFTER_CONTRACTED", {0x0010}},
+  {"CASE_UPPER", {1}},
+  {"MARGIN_FORE", {3}},
+  {"MARGINOPTION_NONE", {0}},
+  {"WRAPVISUALFLAG_NONE", {0x0000}},
+  {"MARK_SMALLRECT", {3}},
+  {"EOL_CRLF", {0}},
+  {"MARK_CHARACTER", {10000}},
+  {"FOLDFLAG_LINEAFTER_EXPANDED", {0x0008}},
+  {"MOD_CHANGETABSTOPS", {0x200000}},
+  {"MOD_INSERTCHECK", {0x100000}},
+  {"MOUSE_PRESS", {1}},
+  {"MARK_BOXPLUS", {12}},
+  {"INDIC_HIDDEN", {5}},
+  {"MULTISTEPUNDOREDO", {0x80}},
+  {"CASEINSENSITIVEBEHAVIOUR_IGNORECASE", {1}},
+  {"SEL_STREAM", {0}},
+  {"WS_VISIBLEAFTERINDENT", {2}},
+  {"FOLDFLAG_LEVELNUMBERS", {0x0040}},
+  {"WRAP_CHAR", {2}},
+  {"SCN_ZOOM", {2018}},
+  {"IDLESTYLING_NONE", {0}},
+  {"CARET_JUMPS", {0x10}},
+  {"MOD_CHANGEANNOTATION", {0x20000}},
+  {"CASE_MIXED", {0}},
+  {"MOD_CTRL", {2}},
+  {"MARK_FULLRECT", {26}},
+  {"MOUSE_DRAG", {2}},
+  {"FOLDACTION_EXPAND", {1}},
+  {"MOD_SUPER", {8}},
+  {"ANNOTATION_BOXED", {2}},
+  {"STYLE_DEFAULT", {32}},
+  {"MARKNUM_FOLDERSUB", {29}},
+  {"ANNOTATION_STANDARD", {1}},
+  {"FOLDFLAG_LINEBEFORE_EXPANDED", {0x0002}},
+  {"IV_NONE", {0}},
+  {"VS_RECTANGULARSELECTION", {1}},
+  {"CURSORWAIT", {4}},
+  {"SCN_PAINTED", {2013}},
+  {"MODEVENTMASKALL", {0x3FFFFF}},
+  {"SEL_THIN", {3}},
+  {"ANNOTATION_HIDDEN", {0}},
+  {"FIND_MATCHCASE", {0x4}},
+  {"SCN_MODIFIED", {2008}},
+  {"MULTILINEUNDOREDO", {0x1000}},
+  {"IV_REAL", {1}},
+  {"MARK_LEFTRECT", {27}},
+  {"MASK_FOLDERS", {-33554432}},
+  {"MARK_BOXPLUSCONNECTED", {13}},
+  {"MARKNUM_FOLDERMIDTAIL", {27}},
+  {"SCN_FOCUSIN", {2028}},
+  {"STYLE_BRACELIGHT", {34}},
+  {"ORDER_PERFORMSORT", {1}},
+  {"MARK_LCORNER", {10}},
+  {"MULTIPASTE_EACH", {1}},
+};
+static const int iface_constants_seeds[] = {
+  0, 0, 0, -3, -5, 3, -7, 0, -10, 1, 2, 1, -11, -12, 2, -17, 0, -18, 0, 0, -19,
+  1, 1, -20, -21, 0, 0, -22, -23, 2, 1, 0, -29, 0, 0, 0, 0, 0, -30, 3, 0, 1,
+  -31, 2, 1, 5, 0, 1, 1, 0, 0, 0, 0, 0, -32, 0, 0, 4, 1, 0, 0, -36, -37, -42, 2,
+  -43, -44, -47, 0, 2, -48, 1, 0, -52, 0, 0, 2, 0, -53, 4, -56, 2, 2, 0, -57, 3,
+  0, -59, 0, 1, 1, 0, -62, 0, -68, -69, 0, 0, 0, -74, 0, 6, 1, -77, 3, 2, -79,
+  1, -80, -84, 0, 0, -88, 0, 0, 0, -90, -101, 0, -106, -107, -108, -109, -111,
+  -116, -120, 0, 0, 0, 4, 0, 2, -121, 0, 2, -122, 0, -124, -125, 0, -127, 2,
+  -134, 2, 0, -135, -140, -142, 0, 0, 0, -143, 5, 0, 0, -144, 0, 2, -150, 0, 1,
+  3, 11, 0, -156, 1, 0, 2, 0, 0, 4, 0, -158, 1, 0, 3, 3, 0, -159, -160, 1, 10,
+  0, -161, 0, 3, 1, 2, -162, -163, 4, -166, 0, 0, 0, -168, 6, 1, 0, -173, 0, 0,
+  0, -176, 1, -177, 0, 1, 0, 3, -181, -190, -192, 0, -198, -200, -201, 0, 0,
+  -204, -210, 1, 5, 0, 0, 0, -213, -214, -225, 0, 8, 2, -227, 0, 7, 22, -228,
+  15, -231, -234, 0, -235, 4, -243, 0, 0, 1, 0
+};
+static const IfaceTable iface_constants = {
+  iface_constants_entries, iface_constants_seeds, 248, 1
+};
+
+static const IfaceEntry iface_functions_entries[] = {
+  {"doc_line_from_visible", {2221, 1, 1, 0}},
+  {"visible_from_doc_line", {2220, 1, 1, 0}},
+  {"search_next", {2367, 1, 1, 7}},
+  {"brace_bad_light_indicator", {2499, 0, 5, 1}},
+  {"replace_target", {2194, 1, 2, 7}},
+  {"move_caret_inside_view", {2401, 0, 0, 0}},
+  {"line_down", {2300, 0, 0, 0}},
+  {"vc_home_rect_extend", {2431, 0, 0, 0}},
+  {"auto_c_active", {2102, 5, 0, 0}},
+  {"clear_all_cmd_keys", {2072, 0, 0, 0}},
+  {"cut", {2177, 0, 0, 0}},
+  {"line_end_extend", {2315, 0, 0, 0}},
+  {"vc_home_extend", {2332, 0, 0, 0}},
+  {"line_end_display", {2347, 0, 0, 0}},
+  {"undo", {2176, 0, 0, 0}},
+  {"text_height", {2279, 1, 1, 0}},
+  {"expand_children", {2239, 0, 1, 1}},
+  {"stuttered_page_down_extend", {2438, 0, 0, 0}},
+  {"style_clear_all", {2050, 0, 0, 0}},
+  {"vertical_centre_caret", {2619, 0, 0, 0}},
+  {"document_start_extend", {2317, 0, 0, 0}},
+  {"stop_record", {3002, 0, 0, 0}},
+  {"page_down", {2322, 0, 0, 0}},
+  {"word_part_right", {2392, 0, 0, 0}},
+  {"replace_sel", {2170, 0, 0, 7}},
+  {"indicator_end", {2509, 1, 1, 1}},
+  {"private_lexer_call", {4013, 1, 1, 1}},
+  {"set_hotspot_active_fore", {2410, 0, 5, 4}},
+  {"del_word_left", {2335, 0, 0, 0}},
+  {"word_right", {2310, 0, 0, 0}},
+  {"add_ref_document", {2376, 0, 0, 1}},
+  {"scroll_to_start", {2628, 0, 0, 0}},
+  {"line_end_display_extend", {2348, 0, 0, 0}},
+  {"cancel", {2325, 0, 0, 0}},
+  {"clear_all", {2004, 0, 0, 0}},
+  {"word_part_left", {2390, 0, 0, 0}},
+  {"line_from_position", {2166, 1, 3, 0}},
+  {"add_undo_action", {2560, 0, 1, 1}},
+  {"change_lexer_state", {2617, 1, 3, 3}},
+  {"auto_c_pos_start", {2103, 3, 0, 0}},
+  {"marker_next", {2047, 1, 1, 1}},
+  {"contracted_fold_next", {2618, 1, 1, 0}},
+  {"clear", {2180, 0, 0, 0}},
+  {"toggle_fold", {2231, 0, 1, 0}},
+  {"edit_toggle_overtype", {2324, 0, 0, 0}},
+  {"count_characters", {2633, 1, 1, 1}},
+  {"marker_get", {2046, 1, 1, 0}},
+  {"get_sel_text", {2161, 1, 0, 8}},
+  {"begin_undo_action", {2078, 0, 0, 0}},
+  {"marker_delete_handle", {2018, 0, 1, 0}},
+  {"back_tab", {2328, 0, 0, 0}},
+  {"grab_focus", {2400, 0, 0, 0}},
+  {"page_up", {2320, 0, 0, 0}},
+  {"point_x_from_position", {2164, 1, 0, 3}},
+  {"get_next_tab_stop", {2677, 1, 1, 1}},
+  {"vc_home_wrap_extend", {2454, 0, 0, 0}},
+  {"fold_all", {2662, 0, 1, 0}},
+  {"marker_symbol_defined", {2529, 1, 1, 0}},
+  {"clear_document_style", {2005, 0, 0, 0}},
+  {"change_insertion", {2672, 0, 2, 7}},
+  {"select_all", {2013, 0, 0, 0}},
+  {"search_in_target", {2197, 1, 2, 7}},
+  {"scroll_range", {2569, 0, 3, 3}},
+  {"marker_enable_highlight", {2293, 0, 5, 0}},
+  {"choose_caret_x", {2399, 0, 0, 0}},
+  {"get_styled_text", {2015, 1, 0, 10}},
+  {"point_y_from_position", {2165, 1, 0, 3}},
+  {"clear_registered_images", {2408, 0, 0, 0}},
+  {"describe_key_word_sets", {4017, 1, 0, 8}},
+  {"create_loader", {2632, 1, 1, 0}},
+  {"home_wrap_extend", {2450, 0, 0, 0}},
+  {"colourise", {4003, 0, 3, 3}},
+  {"line_up_extend", {2303, 0, 0, 0}},
+  {"get_text", {2182, 1, 2, 8}},
+  {"margin_text_clear_all", {2536, 0, 0, 0}},
+  {"line_duplicate", {2404, 0, 0, 0}},
+  {"scroll_to_end", {2629, 0, 0, 0}},
+  {"set_length_for_encode", {2448, 0, 1, 0}},
+  {"load_lexer_library", {4007, 0, 0, 7}},
+  {"set_sel_fore", {2067, 0, 5, 4}},
+  {"hide_selection", {2163, 0, 5, 0}},
+  {"add_selection", {2573, 1, 1, 1}},
+  {"get_hotspot_active_back", {2495, 4, 0, 0}},
+  {"clear_representation", {2667, 0, 7, 0}},
+  {"vc_home_wrap", {2453, 0, 0, 0}},
+  {"vc_home", {2331, 0, 0, 0}},
+  {"append_text", {2282, 0, 2, 7}},
+  {"brace_match", {2353, 3, 3, 0}},
+  {"document_start", {2316, 0, 0, 0}},
+  {"get_line", {2153, 1, 1, 8}},
+  {"line_transpose", {2339, 0, 0, 0}},
+  {"char_position_from_point", {2561, 3, 1, 1}},
+  {"find_indicator_show", {2640, 0, 3, 3}},
+  {"word_part_right_extend", {2393, 0, 0, 0}},
+  {"home_extend", {2313, 0, 0, 0}},
+  {"delete_range", {2645, 0, 3, 1}},
+  {"target_whole_document", {2690, 0, 0, 0}},
+  {"toggle_caret_sticky", {2459, 0, 0, 0}},
+  {"format_range", {2151, 3, 5, 12}},
+  {"indicator_clear_range", {2505, 0, 1, 1}},
+  {"para_down", {2413, 0, 0, 0}},
+  {"set_text", {2181, 0, 0, 7}},
+  {"del_word_right", {2336, 0, 0, 0}},
+  {"auto_c_complete", {2104, 0, 0, 0}},
+  {"search_anchor", {2366, 0, 0, 0}},
+  {"char_right_extend", {2307, 0, 0, 0}},
+  {"word_right_end_extend", {2442, 0, 0, 0}},
+  {"add_styled_text", {2002, 0, 2, 9}},
+  {"allocate", {2446, 0, 1, 0}},
+  {"page_up_extend", {2321, 0, 0, 0}},
+  {"marker_delete", {2044, 0, 1, 1}},
+  {"char_right", {2306, 0, 0, 0}},
+  {"set_visible_policy", {2394, 0, 1, 1}},
+  {"is_range_word", {2691, 5, 3, 3}},
+  {"user_list_show", {2117, 0, 1, 7}},
+  {"char_left_extend", {2305, 0, 0, 0}},
+  {"swap_main_anchor_caret", {2607, 0, 0, 0}},
+  {"line_up_rect_extend", {2427, 0, 0, 0}},
+  {"line_scroll", {2168, 0, 1, 1}},
+  {"set_save_point", {2014, 0, 0, 0}},
+  {"scroll_caret", {2169, 0, 0, 0}},
+  {"annotation_clear_all", {2547, 0, 0, 0}},
+  {"del_line_left", {2395, 0, 0, 0}},
+  {"indicator_fill_range", {2504, 0, 1, 1}},
+  {"allocate_sub_styles", {4020, 1, 1, 1}},
+  {"marker_line_from_handle", {2017, 1, 1, 0}},
+  {"marker_define_rgba_image", {2626, 0, 1, 7}},
+  {"char_left_rect_extend", {2428, 0, 0, 0}},
+  {"line_scroll_down", {2342, 0, 0, 0}},
+  {"marker_define", {2040, 0, 1, 1}},
+  {"document_end_extend", {2319, 0, 0, 0}},
+  {"zoom_in", {2333, 0, 0, 0}},
+  {"para_down_extend", {2414, 0, 0, 0}},
+  {"selection_duplicate", {2469, 0, 0, 0}},
+  {"document_end", {2318, 0, 0, 0}},
+  {"null", {2172, 0, 0, 0}},
+  {"auto_c_stops", {2105, 0, 0, 7}},
+  {"set_sel_back", {2068, 0, 5, 4}},
+  {"property_names", {4014, 1, 0, 8}},
+  {"home", {2312, 0, 0, 0}},
+  {"add_text", {2001, 0, 2, 7}},
+  {"vc_home_display", {2652, 0, 0, 0}},
+  {"word_end_position", {2267, 1, 3, 5}},
+  {"goto_line", {2024, 0, 1, 0}},
+  {"home_wrap", {2349, 0, 0, 0}},
+  {"line_up", {2302, 0, 0, 0}},
+  {"para_up_extend", {2416, 0, 0, 0}},
+  {"get_line_sel_end_position", {2425, 3, 1, 0}},
+  {"copy", {2178, 0, 0, 0}},
+  {"set_chars_default", {2444, 0, 0, 0}},
+  {"search_prev", {2368, 1, 1, 7}},
+  {"marker_define_pixmap", {2049, 0, 1, 7}},
+  {"convert_eols", {2029, 0, 1, 0}},
+  {"copy_allow_line", {2519, 0, 0, 0}},
+  {"home_display", {2345, 0, 0, 0}},
+  {"ensure_visible_enforce_policy", {2234, 0, 1, 0}},
+  {"target_as_utf8", {2447, 1, 0, 8}},
+  {"assign_cmd_key", {2070, 0, 6, 1}},
+  {"ensure_visible", {2232, 0, 1, 0}},
+  {"copy_text", {2420, 0, 2, 7}},
+  {"position_from_point", {2022, 3, 1, 1}},
+  {"copy_range", {2419, 0, 3, 3}},
+  {"call_tip_show", {2200, 0, 3, 7}},
+  {"page_up_rect_extend", {2433, 0, 0, 0}},
+  {"auto_c_cancel", {2101, 0, 0, 0}},
+  {"marker_delete_all", {2045, 0, 1, 0}},
+  {"set_hotspot_active_back", {2411, 0, 5, 4}},
+  {"release_all_extended_styles", {2552, 0, 0, 0}},
+  {"char_right_rect_extend", {2429, 0, 0, 0}},
+  {"line_down_extend", {2301, 0, 0, 0}},
+  {"line_end_wrap_extend", {2452, 0, 0, 0}},
+  {"position_from_point_close", {2023, 3, 1, 1}},
+  {"get_cur_line", {2027, 1, 2, 8}},
+  {"line_length", {2350, 1, 1, 0}},
+  {"fold_children", {2238, 0, 1, 1}},
+  {"lines_join", {2288, 0, 0, 0}},
+  {"move_selected_lines_up", {2620, 0, 0, 0}},
+  {"free_sub_styles", {4023, 0, 0, 0}},
+  {"can_redo", {2016, 5, 0, 0}},
+  {"upper_case", {2341, 0, 0, 0}},
+  {"indicator_start", {2508, 1, 1, 1}},
+  {"stuttered_page_up_extend", {2436, 0, 0, 0}},
+  {"line_delete", {2338, 0, 0, 0}},
+  {"page_down_rect_extend", {2434, 0, 0, 0}},
+  {"lower_case", {2340, 0, 0, 0}},
+  {"position_from_line", {2167, 3, 1, 0}},
+  {"clear_cmd_key", {2071, 0, 6, 0}},
+  {"tab", {2327, 0, 0, 0}},
+  {"brace_bad_light", {2352, 0, 3, 0}},
+  {"line_end_wrap", {2451, 0, 0, 0}},
+  {"end_undo_action", {2079, 0, 0, 0}},
+  {"set_fold_margin_hi_colour", {2291, 0, 5, 4}},
+  {"clear_tab_stops", {2675, 0, 1, 0}},
+  {"can_undo", {2174, 5, 0, 0}},
+  {"line_scroll_up", {2343, 0, 0, 0}},
+  {"set_selection", {2572, 1, 1, 1}},
+  {"word_right_extend", {2311, 0, 0, 0}},
+  {"marker_previous", {2048, 1, 1, 1}},
+  {"get_last_child", {2224, 1, 1, 1}},
+  {"encoded_from_utf8", {2449, 1, 7, 8}},
+  {"find_column", {2456, 1, 1, 1}},
+  {"rotate_selection", {2606, 0, 0, 0}},
+  {"zoom_out", {2334, 0, 0, 0}},
+  {"word_left", {2308, 0, 0, 0}},
+  {"set_fold_margin_colour", {2290, 0, 5, 4}},
+  {"replace_target_re", {2195, 1, 2, 7}},
+  {"delete_back_not_line", {2344, 0, 0, 0}},
+  {"del_line_right", {2396, 0, 0, 0}},
+  {"word_left_extend", {2309, 0, 0, 0}},
+  {"find_text", {2150, 3, 1, 11}},
+  {"del_word_right_end", {2518, 0, 0, 0}},
+  {"get_hotspot_active_fore", {2494, 4, 0, 0}},
+  {"set_styling", {2033, 0, 2, 1}},
+  {"lines_split", {2289, 0, 1, 0}},
+  {"line_down_rect_extend", {2426, 0, 0, 0}},
+  {"paste", {2179, 0, 0, 0}},
+  {"drop_selection_n", {2671, 0, 1, 0}},
+  {"char_position_from_point_close", {2562, 3, 1, 1}},
+  {"set_target_range", {2686, 0, 3, 3}},
+  {"target_from_selection", {2287, 0, 0, 0}},
+  {"can_paste", {2173, 5, 0, 0}},
+  {"show_lines", {2226, 0, 1, 1}},
+  {"register_image", {2405, 0, 1, 7}},
+  {"clear_selections", {2571, 0, 0, 0}},
+  {"brace_highlight_indicator", {2498, 0, 5, 1}},
+  {"find_indicator_flash", {2641, 0, 3, 3}},
+  {"property_type", {4015, 1, 7, 0}},
+  {"wrap_count", {2235, 1, 1, 0}},
+  {"fold_line", {2237, 0, 1, 1}},
+  {"call_tip_active", {2202, 5, 0, 0}},
+  {"create_document", {2375, 1, 0, 0}},
+  {"word_left_end", {2439, 0, 0, 0}},
+  {"move_selected_lines_down", {2621, 0, 0, 0}},
+  {"add_tab_stop", {2676, 0, 1, 1}},
+  {"position_after", {2418, 3, 3, 0}},
+  {"empty_undo_buffer", {2175, 0, 0, 0}},
+  {"line_cut", {2337, 0, 0, 0}},
+  {"get_line_sel_start_position", {2424, 3, 1, 0}},
+  {"multiple_select_add_each", {2689, 0, 0, 0}},
+  {"position_before", {2417, 3, 3, 0}},
+  {"indicator_value_at", {2507, 1, 1, 1}},
+  {"home_display_extend", {2346, 0, 0, 0}},
+  {"position_relative", {2670, 3, 3, 1}},
+  {"marker_add", {2043, 1, 1, 1}},
+  {"word_right_end", {2441, 0, 0, 0}},
+  {"get_text_range", {2162, 1, 0, 10}},
+  {"hide_lines", {2227, 0, 1, 1}},
+  {"set_y_caret_policy", {2403, 0, 1, 1}},
+  {"line_end_rect_extend", {2432, 0, 0, 0}},
+  {"set_whitespace_fore", {2084, 0, 5, 4}},
+  {"text_width", {2276, 1, 1, 7}},
+  {"multiple_select_add_next", {2688, 0, 0, 0}},
+  {"release_document", {2377, 0, 0, 1}},
+  {"word_left_end_extend", {2440, 0, 0, 0}},
+  {"redo", {2011, 0, 0, 0}},
+  {"set_styling_ex", {2073, 0, 2, 7}},
+  {"register_rgba_image", {2627, 0, 1, 7}},
+  {"goto_pos", {2025, 0, 3, 0}},
+  {"new_line", {2329, 0, 0, 0}},
+  {"find_indicator_hide", {2642, 0, 0, 0}},
+  {"start_styling", {2032, 0, 3, 1}},
+  {"form_feed", {2330, 0, 0, 0}},
+  {"line_copy", {2455, 0, 0, 0}},
+  {"brace_highlight", {2351, 0, 3, 3}},
+  {"get_range_pointer", {2643, 1, 1, 1}},
+  {"insert_text", {2003, 0, 3, 7}},
+  {"auto_c_show", {2100, 0, 1, 7}},
+  {"set_x_caret_policy", {2402, 0, 1, 1}},
+  {"call_tip_cancel", {2201, 0, 0, 0}},
+  {"word_start_position", {2266, 1, 3, 5}},
+  {"allocate_extended_styles", {2553, 1, 1, 0}},
+  {"call_tip_set_hlt", {2204, 0, 1, 1}},
+  {"delete_back", {2326, 0, 0, 0}},
+  {"call_tip_pos_start", {2203, 3, 0, 0}},
+  {"start_record", {3001, 0, 0, 0}},
+  {"line_end", {2314, 0, 0, 0}},
+  {"marker_add_set", {2466, 0, 1, 1}},
+  {"stuttered_page_down", {2437, 0, 0, 0}},
+  {"set_empty_selection", {2556, 0, 3, 0}},
+  {"word_part_left_extend", {2391, 0, 0, 0}},
+  {"char_left", {2304, 0, 0, 0}},
+  {"set_sel", {2160, 0, 3, 3}},
+  {"style_reset_default", {2058, 0, 0, 0}},
+  {"use_pop_up", {2371, 0, 5, 0}},
+  {"vc_home_display_extend", {2653, 0, 0, 0}},
+  {"stuttered_page_up", {2435, 0, 0, 0}},
+  {"para_up", {2415, 0, 0, 0}},
+  {"home_rect_extend", {2430, 0, 0, 0}},
+  {"set_whitespace_back", {2085, 0, 5, 4}},
+  {"page_down_extend", {2323, 0, 0, 0}},
+  {"describe_property", {4016, 1, 7, 8}},
+  {"indicator_all_on_for", {2506, 1, 1, 0}},
+  {"auto_c_select", {2108, 0, 0, 7}},
+};
+static const int iface_functions_seeds[] = {
+  -1, -2, 1, 4, 0, 0, -5, -6, -7, -11, 1, 0, 0, -13, 1, -16, -20, -25, 0, 0, 1,
+  -26, 0, -29, -32, -33, -34, -41, 1, -42, 3, -43, -45, 1, 0, 0, -50, 2, 2, -52,
+  -53, -54, -55, 1, -56, 0, -57, 1, -59, -62, 0, 0, -64, 0, 0, 1, -65, 1, 1, 0,
+  -68, -70, 0, -71, -72, 0, 0, 3, 0, -77, -80, 0, 1, 0, 0, -87, 3, -89, 0, 7,
+  -91, 0, -92, 1, -93, 1, 1, 0, 0, 4, 2, 1, -97, 3, 0, 0, -100, -101, -105, 0,
+  0, -113, 0, -115, 0, -119, 3, -120, 0, -123, -124, -126, -128, 0, -130, 0,
+  -131, 0, -133, 0, 2, 0, 1, -139, 0, -144, 1, 10, 0, -147, 3, 2, -153, 0, -154,
+  1, 4, 0, -155, 0, -165, -168, -172, -173, -176, 0, 0, 2, 0, 0, -179, -182, 7,
+  -184, 1, -185, 0, 2, 0, 0, 0, -187, 0, 1, 0, 4, -189, 0, 0, 1, 1, 1, -190, 0,
+  -191, 2, 1, 0, -195, -196, 0, 0, -200, -202, 0, -203, -204, 0, -205, 3, -206,
+  -207, -210, -211, 0, 0, 0, 0, 0, 0, 4, 5, 1, -212, -217, 0, 6, 0, 1, 0, 0, 0,
+  0, 0, -218, 0, -220, 1, -227, 0, 0, -228, 0, 0, 0, 2, 2, -229, 4, -238, -240,
+  1, 0, -243, 0, 2, 0, -244, 0, 1, -248, 0, 0, -250, -252, 0, 0, 0, 0, 0, 0, 2,
+  0, -255, -256, 0, -258, 1, 6, 1, 0, -262, 0, -266, 3, -267, 0, 2, 2, -272,
+  -273, 7, 0, 8, -274, 7, -276, -277, 0, 0, -281, 0, -282, -286, 4, -290, 0, 12,
+  1, -291, 0, 1, 0
+};
+static const IfaceTable iface_functions = {
+  iface_functions_entries, iface_functions_seeds, 293, 4
+};
+
+static const IfaceEntry iface_properties_entries[] = {
+  {"selection_n_caret", {2577, 2576, 3, 1}},
+  {"whitespace_chars", {2647, 2443, 8, 0}},
+  {"extra_descent", {2528, 2527, 1, 0}},
+  {"wrap_visual_flags_location", {2463, 2462, 1, 0}},
+  {"caret_line_visible", {2095, 2096, 5, 0}},
+  {"selections", {2570, 0, 1, 0}},
+  {"style_bold", {2483, 2053, 5, 1}},
+  {"margin_text", {2531, 2530, 8, 1}},
+  {"line_end_types_active", {2658, 0, 1, 0}},
+  {"automatic_fold", {2664, 2663, 1, 0}},
+  {"current_pos", {2008, 2141, 3, 0}},
+  {"text_length", {2183, 0, 1, 0}},
+  {"modify", {2159, 0, 5, 0}},
+  {"print_colour_mode", {2149, 2148, 1, 0}},
+  {"selection_start", {2143, 2142, 3, 0}},
+  {"marker_back", {0, 2042, 4, 1}},
+  {"read_only", {2140, 2171, 5, 0}},
+  {"call_tip_pos_start", {0, 2214, 1, 0}},
+  {"wrap_start_indent", {2465, 2464, 1, 0}},
+  {"primary_style_from_style", {4028, 0, 1, 1}},
+  {"style_weight", {2064, 2063, 1, 1}},
+  {"margin_sensitive_n", {2247, 2246, 5, 1}},
+  {"zoom", {2374, 2373, 1, 0}},
+  {"cursor", {2387, 2386, 1, 0}},
+  {"annotation_visible", {2549, 2548, 1, 0}},
+  {"rectangular_selection_modifier", {2599, 2598, 1, 0}},
+  {"marker_fore", {0, 2041, 4, 1}},
+  {"lines_on_screen", {2370, 0, 1, 0}},
+  {"margin_style_offset", {2538, 2537, 1, 0}},
+  {"caret_fore", {2138, 2069, 4, 0}},
+  {"margin_styles", {2535, 2534, 8, 1}},
+  {"edge_column", {2360, 2361, 1, 0}},
+  {"ime_interaction", {2678, 2679, 1, 0}},
+  {"fold_expanded", {2230, 2229, 5, 1}},
+  {"phases_draw", {2673, 2674, 1, 0}},
+  {"auto_c_order", {2661, 2660, 1, 0}},
+  {"style_back", {2482, 2052, 4, 1}},
+  {"marker_back_selected", {0, 2292, 4, 1}},
+  {"status", {2383, 2382, 1, 0}},
+  {"layout_cache", {2273, 2272, 1, 0}},
+  {"style_character_set", {2490, 2066, 1, 1}},
+  {"end_at_last_line", {2278, 2277, 5, 0}},
+  {"caret_style", {2513, 2512, 1, 0}},
+  {"style_case", {2489, 2060, 1, 1}},
+  {"style_visible", {2491, 2074, 5, 1}},
+  {"eol_mode", {2030, 2031, 1, 0}},
+  {"mouse_down_captures", {2385, 2384, 5, 0}},
+  {"char_at", {2007, 0, 1, 3}},
+  {"sel_eol_filled", {2479, 2480, 5, 0}},
+  {"call_tip_fore_hlt", {0, 2207, 4, 0}},
+  {"distance_to_secondary_styles", {4025, 0, 1, 0}},
+  {"direct_pointer", {2185, 0, 1, 0}},
+  {"extra_ascent", {2526, 2525, 1, 0}},
+  {"rectangular_selection_caret", {2589, 2588, 3, 0}},
+  {"representation", {2666, 2665, 8, 7}},
+  {"indic_fore", {2083, 2082, 4, 1}},
+  {"indic_flags", {2685, 2684, 1, 1}},
+  {"selection_n_start", {2585, 2584, 3, 1}},
+  {"multiple_selection", {2564, 2563, 5, 0}},
+  {"buffered_draw", {2034, 2035, 5, 0}},
+  {"margin_options", {2557, 2539, 1, 0}},
+  {"margin_cursor_n", {2249, 2248, 1, 1}},
+  {"length", {2006, 0, 1, 0}},
+  {"selection_n_anchor_virtual_space", {2583, 2582, 1, 1}},
+  {"style_changeable", {2492, 2099, 5, 1}},
+  {"line_count", {2154, 0, 1, 0}},
+  {"indentation_guides", {2133, 2132, 1, 0}},
+  {"word_chars", {2646, 2077, 8, 0}},
+  {"style_eol_filled", {2487, 2057, 5, 1}},
+  {"hotspot_single_line", {2497, 2421, 5, 0}},
+  {"mod_event_mask", {2378, 2359, 1, 0}},
+  {"caret_line_back", {2097, 2098, 4, 0}},
+  {"print_magnification", {2147, 2146, 1, 0}},
+  {"scroll_width_tracking", {2517, 2516, 5, 0}},
+  {"margin_right", {2158, 2157, 1, 0}},
+  {"selection_empty", {2650, 0, 5, 0}},
+  {"style_bits_needed", {4011, 0, 1, 0}},
+  {"whitespace_size", {2087, 2086, 1, 0}},
+  {"indicator_current", {2501, 2500, 1, 0}},
+  {"auto_c_fill_ups", {0, 2112, 7, 0}},
+  {"additional_caret_fore", {2605, 2604, 4, 0}},
+  {"selection_end", {2145, 2144, 3, 0}},
+  {"key_words", {0, 4005, 7, 1}},
+  {"line_indentation", {2127, 2126, 1, 1}},
+  {"rgba_image_height", {0, 2625, 1, 0}},
+  {"selection_n_caret_virtual_space", {2581, 2580, 1, 1}},
+  {"call_tip_position", {0, 2213, 5, 0}},
+  {"v_scroll_bar", {2281, 2280, 5, 0}},
+  {"view_eol", {2355, 2356, 5, 0}},
+  {"indic_alpha", {2524, 2523, 1, 1}},
+  {"style_font", {2486, 2056, 8, 1}},
+  {"target_start", {2191, 2190, 3, 0}},
+  {"all_lines_visible", {2236, 0, 5, 0}},
+  {"search_flags", {2199, 2198, 1, 0}},
+  {"caret_period", {2075, 2076, 1, 0}},
+  {"rectangular_selection_anchor", {2591, 2590, 3, 0}},
+  {"idle_styling", {2693, 2692, 1, 0}},
+  {"sub_styles_start", {4021, 0, 1, 1}},
+  {"auto_c_separator", {2107, 2106, 1, 0}},
+  {"auto_c_choose_single", {2114, 2113, 5, 0}},
+  {"wrap_indent_mode", {2473, 2472, 1, 0}},
+  {"scroll_width", {2275, 2274, 1, 0}},
+  {"max_line_state", {2094, 0, 1, 0}},
+  {"selection_n_end", {2587, 2586, 3, 1}},
+  {"caret_line_visible_always", {2654, 2655, 5, 0}},
+  {"additional_sel_alpha", {2603, 2602, 1, 0}},
+  {"lexer", {4002, 4001, 1, 0}},
+  {"auto_c_multi", {2637, 2636, 1, 0}},
+  {"two_phase_draw", {2283, 2284, 5, 0}},
+  {"h_scroll_bar", {2131, 2130, 5, 0}},
+  {"annotation_style_offset", {2551, 2550, 1, 0}},
+  {"line_indent_position", {2128, 0, 3, 1}},
+  {"indic_hover_style", {2681, 2680, 1, 1}},
+  {"property_int", {4010, 0, 1, 7}},
+  {"auto_c_ignore_case", {2116, 2115, 5, 0}},
+  {"caret_sticky", {2457, 2458, 1, 0}},
+  {"style_size", {2485, 2055, 1, 1}},
+  {"mouse_dwell_time", {2265, 2264, 1, 0}},
+  {"line_end_types_allowed", {2657, 2656, 1, 0}},
+  {"punctuation_chars", {2649, 2648, 8, 0}},
+  {"caret_line_back_alpha", {2471, 2470, 1, 0}},
+  {"view_ws", {2020, 2021, 1, 0}},
+  {"indic_under", {2511, 2510, 5, 1}},
+  {"selection_mode", {2423, 2422, 1, 0}},
+  {"annotation_lines", {2546, 0, 1, 1}},
+  {"target_end", {2193, 2192, 3, 0}},
+  {"overtype", {2187, 2186, 5, 0}},
+  {"call_tip_use_style", {0, 2212, 1, 0}},
+  {"property", {4008, 4004, 8, 7}},
+  {"main_selection", {2575, 2574, 1, 0}},
+  {"multi_paste", {2615, 2614, 1, 0}},
+  {"print_wrap_mode", {2407, 2406, 1, 0}},
+  {"annotation_styles", {2545, 2544, 8, 1}},
+  {"style_size_fractional", {2062, 2061, 1, 1}},
+  {"selection_is_rectangle", {2372, 0, 5, 0}},
+  {"direct_function", {2184, 0, 1, 0}},
+  {"line_visible", {2228, 0, 5, 1}},
+  {"auto_c_case_insensitive_behaviour", {2635, 2634, 1, 0}},
+  {"style_italic", {2484, 2054, 5, 1}},
+  {"marker_alpha", {0, 2476, 1, 1}},
+  {"code_page", {2137, 2037, 1, 0}},
+  {"technology", {2631, 2630, 1, 0}},
+  {"additional_carets_visible", {2609, 2608, 5, 0}},
+  {"indent", {2123, 2122, 1, 0}},
+  {"paste_convert_endings", {2468, 2467, 5, 0}},
+  {"fold_parent", {2225, 0, 1, 1}},
+  {"edge_colour", {2364, 2365, 4, 0}},
+  {"sub_styles_length", {4022, 0, 1, 1}},
+  {"undo_collection", {2019, 2012, 5, 0}},
+  {"doc_pointer", {2357, 2358, 1, 0}},
+  {"font_quality", {2612, 2611, 1, 0}},
+  {"wrap_visual_flags", {2461, 2460, 1, 0}},
+  {"sub_style_bases", {4026, 0, 8, 0}},
+  {"margin_type_n", {2241, 2240, 1, 1}},
+  {"rgba_image_scale", {0, 2651, 1, 0}},
+  {"indic_style", {2081, 2080, 1, 1}},
+  {"auto_c_current", {2445, 0, 1, 0}},
+  {"auto_c_auto_hide", {2119, 2118, 5, 0}},
+  {"auto_c_cancel_at_start", {2111, 2110, 5, 0}},
+  {"identifiers", {0, 4024, 7, 1}},
+  {"wrap_mode", {2269, 2268, 1, 0}},
+  {"style_hot_spot", {2493, 2409, 5, 1}},
+  {"indic_hover_fore", {2683, 2682, 4, 1}},
+  {"style_bits", {2091, 2090, 1, 0}},
+  {"additional_carets_blink", {2568, 2567, 5, 0}},
+  {"focus", {2381, 2380, 5, 0}},
+  {"identifier", {2623, 2622, 1, 0}},
+  {"rectangular_selection_anchor_virtual_space", {2595, 2594, 1, 0}},
+  {"tab_indents", {2261, 2260, 5, 0}},
+  {"tab_width", {2121, 2036, 1, 0}},
+  {"property_expanded", {4009, 0, 8, 7}},
+  {"back_space_un_indents", {2263, 2262, 5, 0}},
+  {"annotation_text", {2541, 2540, 8, 1}},
+  {"character_pointer", {2520, 0, 1, 0}},
+  {"tag", {2616, 0, 8, 1}},
+  {"style_underline", {2488, 2059, 5, 1}},
+  {"auto_c_type_separator", {2285, 2286, 1, 0}},
+  {"margin_width_n", {2243, 2242, 1, 1}},
+  {"edge_mode", {2362, 2363, 1, 0}},
+  {"additional_sel_back", {0, 2601, 4, 0}},
+  {"rgba_image_width", {0, 2624, 1, 0}},
+  {"use_tabs", {2125, 2124, 5, 0}},
+  {"sel_alpha", {2477, 2478, 1, 0}},
+  {"auto_c_max_width", {2209, 2208, 1, 0}},
+  {"highlight_guide", {2135, 2134, 1, 0}},
+  {"margin_mask_n", {2245, 2244, 1, 1}},
+  {"annotation_style", {2543, 2542, 1, 1}},
+  {"mouse_selection_rectangular_switch", {2669, 2668, 5, 0}},
+  {"lexer_language", {4012, 4006, 8, 0}},
+  {"virtual_space_options", {2597, 2596, 1, 0}},
+  {"line_end_types_supported", {4018, 0, 1, 0}},
+  {"style_from_sub_style", {4027, 0, 1, 1}},
+  {"line_state", {2093, 2092, 1, 1}},
+  {"line_end_position", {2136, 0, 3, 1}},
+  {"auto_c_max_height", {2211, 2210, 1, 0}},
+  {"caret_width", {2189, 2188, 1, 0}},
+  {"indic_outline_alpha", {2559, 2558, 1, 1}},
+  {"end_styled", {2028, 0, 3, 0}},
+  {"control_char_symbol", {2389, 2388, 1, 0}},
+  {"column", {2129, 0, 1, 3}},
+  {"first_visible_line", {2152, 2613, 1, 0}},
+  {"selection_n_anchor", {2579, 2578, 3, 1}},
+  {"fold_level", {2223, 2222, 1, 1}},
+  {"style_at", {2010, 0, 1, 3}},
+  {"x_offset", {2398, 2397, 1, 0}},
+  {"additional_sel_fore", {0, 2600, 4, 0}},
+  {"indicator_value", {2503, 2502, 1, 0}},
+  {"margin_left", {2156, 2155, 1, 0}},
+  {"position_cache", {2515, 2514, 1, 0}},
+  {"call_tip_back", {0, 2205, 4, 0}},
+  {"fold_flags", {0, 2233, 1, 0}},
+  {"rectangular_selection_caret_virtual_space", {2593, 2592, 1, 0}},
+  {"target_text", {2687, 0, 8, 0}},
+  {"margin_style", {2533, 2532, 1, 1}},
+  {"anchor", {2009, 2026, 3, 0}},
+  {"auto_c_drop_rest_of_word", {2271, 2270, 5, 0}},
+  {"hotspot_active_underline", {2496, 2412, 5, 0}},
+  {"style_fore", {2481, 2051, 4, 1}},
+  {"call_tip_fore", {0, 2206, 4, 0}},
+  {"auto_c_current_text", {2610, 0, 8, 0}},
+  {"gap_position", {2644, 0, 3, 0}},
+  {"additional_selection_typing", {2566, 2565, 5, 0}},
+};
+static const int iface_properties_seeds[] = {
+  1, 0, -1, 1, 1, 0, 0, 1, -3, 1, -10, 1, 1, -11, 0, 0, 0, -13, 0, 3, 0, -16,
+  -17, -19, 1, 1, -20, 0, 1, -22, -23, -24, 0, -25, 0, -29, 0, 0, 0, -33, -34,
+  0, -35, 1, 3, 0, 0, 0, -37, -39, 0, -41, 0, 0, -42, 0, 0, -46, 1, 1, 0, 5, 1,
+  -47, 1, -49, -53, 0, -55, -56, 2, 1, 1, 5, -59, -60, 0, 0, -61, 1, 0, -63, 1,
+  -64, 0, -65, -67, 0, 1, 0, 0, 0, 0, -68, -75, -77, 0, -81, -83, 0, 0, 0, 2,
+  -84, 0, -87, 0, 3, 0, -93, 0, -94, -96, 2, -104, 0, 0, 0, -106, 8, 0, -107, 0,
+  0, -108, 0, 5, 2, -112, 0, -115, 1, 0, 0, -119, -120, 3, 1, 0, 2, 0, 4, 2,
+  -122, 0, 0, 0, -124, -126, 0, 2, 1, 4, 3, 3, -128, 1, 1, 0, 3, 0, 0, 0, -132,
+  0, 0, 1, -133, -134, 3, 1, 5, 0, 0, -140, 0, -143, 0, 2, 4, 0, -144, 3, 0, 1,
+  12, 0, 7, 9, -145, 0, 0, 3, -148, -152, 0, 0, 0, 2, 0, -157, -170, -174, -177,
+  0, -178, -184, 7, 5, -186, -187, -201, 0, 1, -204, -205, 0, -221, 14, 0, 0,
+  -222
+};
+static const IfaceTable iface_properties = {
+  iface_properties_entries, iface_properties_seeds, 222, 4
+};
@@ -5,17 +5,27 @@
 #include <locale.h>
 #include <iconv.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#if __linux__
+#include <sys/stat.h>
+#include <time.h>
+#if !_WIN32
+#include <fcntl.h>
 #include <unistd.h>
-#elif _WIN32
+#endif
+#if __linux__
+#include <sys/inotify.h>
+#endif
+#if _WIN32
 #include <windows.h>
 #include <fcntl.h>
+#include <io.h>
 #define main main_
 #elif __APPLE__
 #include <mach-o/dyld.h>
+#include <mach/mach_time.h>
 #elif (__FreeBSD__ || __NetBSD__ || __OpenBSD__)
 #define u_int unsigned int // 'u_int' undefined when _POSIX_SOURCE is defined
 #include <sys/types.h>
@@ -29,6 +39,7 @@
 #endif
 #elif CURSES
 #if !_WIN32
+#include <pthread.h>
 #include <signal.h>
 #include <sys/ioctl.h>
 #include <sys/select.h>
@@ -53,6 +64,8 @@
 #include "cdk_int.h"
 #include "termkey.h"
 #endif
+#include "iface.h"
+#include "tre.h"
 
 // GTK definitions and macros.
 #if GTK
@@ -73,6 +86,10 @@ typedef GtkWidget Scintilla;
 #define gtk_vbox_new(_,s) gtk_box_new(GTK_ORIENTATION_VERTICAL, s)
 #define gtk_hbox_new(_,s) gtk_box_new(GTK_ORIENTATION_HORIZONTAL, s)
 #endif
+// Translate GLib 2.32 threads API to GLib 2.28 for compatibility.
+#if !GLIB_CHECK_VERSION(2,32,0)
+#define g_thread_new(_,func,data) g_thread_create(func, data, TRUE, NULL)
+#endif
 // Win32 single-instance functionality.
 #if _WIN32
 #define g_application_command_line_get_arguments(_,__) \
@@ -114,7 +131,9 @@ typedef GtkWidget Scintilla;
 #define lua_getfield(l, t, k) (lua_getfield(l, t, k), lua_type(l, -1))
 #define lua_rawgeti(l, i, n) (lua_rawgeti(l, i, n), lua_type(l, -1))
 #define lua_gettable(l, i) (lua_gettable(l, i), lua_type(l, -1))
+#define lua_rawget(l, i) (lua_rawget(l, i), lua_type(l, -1))
 #define luaL_openlibs(l) luaL_openlibs(l), luaopen_utf8(l)
+#define lua_dump(l, w, d, s) lua_dump(l, w, d)
 #define lL_openlib(l, n) \
   (lua_pushcfunction(l, luaopen_##n), lua_pushstring(l, #n), lua_call(l, 1, 0))
 LUALIB_API int luaopen_utf8(lua_State *);
@@ -127,6 +146,13 @@ static const char *platform;
 
 // User interface objects and related macros.
 static Scintilla *focused_view, *dummy_view, *command_entry;
+static sptr_t dummy_doc; // the document loaded in dummy_view, if any
+// Direct functions and pointers of recently used Scintilla views.
+static struct {
+  Scintilla *view;
+  SciFnDirect f;
+  sptr_t ptr;
+} directs[4];
 #if GTK
 // GTK window.
 static GtkWidget *window, *menubar, *tabbar, *statusbar[2];
@@ -237,17 +263,345 @@ static int show_tabs = TRUE;
 static int tab_sync;
 #endif
 enum {SVOID, SINT, SLEN, SPOS, SCOLOR, SBOOL, SKEYMOD, SSTRING, SSTRINGRET};
+// Text slices.
+typedef struct {
+  sptr_t doc; // the Scintilla document the slice belongs to
+  int start, length; // range of text in the document
+  unsigned int version; // value of text_version when the slice was created
+  int ref; // registry reference to a string copy of the text, if any
+} Slice;
+static unsigned int text_version; // incremented on each text modification
+static int mod_event_mask = SC_MODEVENTMASKALL; // for all views
+// Text modifications coalesced into 'modified_range' events.
+typedef struct {
+  sptr_t doc; // the Scintilla document modified
+  int start, end; // union range of modified text in the current document
+  int lines_added; // net number of lines added
+} ModifiedRange;
+static ModifiedRange *modified_ranges;
+static int num_modified_ranges, max_modified_ranges;
+#if GTK
+static unsigned int modified_ranges_idle; // source ID of the pending emission
+#endif
+// Documents with open bulk or undo action scopes, whose modifications are
+// coalesced until the outermost scope ends.
+typedef struct {
+  sptr_t doc; // the Scintilla document
+  int depth; // number of open scopes
+  int undo_depth; // number of those scopes that are undo actions
+} BulkScope;
+static BulkScope *bulk_scopes;
+static int num_bulk_scopes, max_bulk_scopes;
+static size_t alloc_count; // number of Lua allocations made
+// Copies of `events.profile` and `events.slow_handler_time`, kept up to date by
+// `events._monitor()`, so emitting events does not look them up.
+static int profile_events;
+static double slow_handler_time;
+#if LUA_VERSION_NUM >= 502
+static lua_Alloc default_alloc;
+#endif
+// Trace spans.
+typedef struct {
+  char name[64]; // the span's name
+  const char *category; // the span's category
+  int msg; // the Scintilla message sent, if any
+  long long start, duration; // in nanoseconds
+} Span;
+#define MAX_OPEN_SPANS 64
+#define MAX_SPANS (1 << 22) // limit for trace.start()'s ring buffer size
+static Span *spans, open_spans[MAX_OPEN_SPANS];
+static size_t max_spans, num_spans; // ring buffer size and number of spans
+static int num_open_spans, tracing;
+// Files being saved by buffer:save_file().
+typedef struct SaveJob {
+  sptr_t doc; // the document saved, referenced until the save is finished
+  const char *text; // the document's text, which must not change until then
+  size_t len; // the length of the text
+  char *encoding; // the encoding to convert the text to, if any
+  iconv_t cd; // the conversion descriptor for that encoding
+  char *filename, *tmpname; // the file to save and the file written first
+  int mode; // the permissions of the file to save, or -1 if it is new
+#if !_WIN32
+  uid_t uid; // the owner of the file to save
+  gid_t gid; // the group of the file to save
+#endif
+  int in_place; // whether or not to write the file itself, as for hard links
+  int error; // errno value of the first failure, or 0
+  int ref; // registry reference to the Lua function to call when finished
+  int threaded; // whether or not the job is running in a separate thread
+#if GTK
+  GThread *thread;
+#elif !_WIN32
+  pthread_t thread;
+#endif
+  struct SaveJob *next;
+} SaveJob;
+static SaveJob *save_jobs;
+static unsigned int num_saves; // for unique temporary filenames
+#if (CURSES && !_WIN32)
+static int save_pipe[2] = {-1, -1}; // finished jobs are written to this pipe
+#endif
+// Open files watched for changes. Their directories are watched instead of
+// them so that files replaced by renaming another file over them stay watched.
+#if __linux__
+typedef struct {
+  char *filename; // the file's absolute path
+  const char *name; // the file's name within its directory
+  int wd; // the inotify watch descriptor of the file's directory, or -1
+  int changed; // whether or not a change has yet to be reported
+} WatchedFile;
+static WatchedFile *watched_files;
+static int num_watched_files, max_watched_files, watch_fd = -1;
+#if GTK
+static unsigned int watch_timer; // source ID of the pending report, if any
+#else
+static long long watch_deadline; // when to report pending changes, or 0
+#endif
+#endif
+#define WATCH_DELAY 100 // ms to collect a burst of changes before reporting it
 
 // Forward declarations.
 static void new_buffer(sptr_t);
 static Scintilla *new_view(sptr_t);
 static int lL_init(lua_State *, int, char **, int);
+static int lL_event(lua_State *, const char *, ...);
 LUALIB_API int luaopen_lpeg(lua_State *), luaopen_lfs(lua_State *);
 LUALIB_API int luaopen_spawn(lua_State *);
 LUALIB_API int lspawn_pushfds(lua_State *), lspawn_readfds(lua_State *);
 
+/**
+ * Pushes onto the stack the list of handlers connected to the given event and
+ * returns whether or not that list exists.
+ * Lists come from the 'ta_events' registry table (`events._handlers`) and are
+ * cached in the 'ta_eventlists' registry table by event name pointer, since C
+ * always emits events using string literals. Nothing is pushed if the list does
+ * not exist.
+ * @param L The Lua state.
+ * @param name The event name.
+ * @return TRUE or FALSE
+ */
+static int l_pusheventhandlers(lua_State *L, const char *name) {
+  int top = lua_gettop(L);
+  if (lua_getfield(L, LUA_REGISTRYINDEX, "ta_eventlists") != LUA_TTABLE)
+    return (lua_settop(L, top), FALSE); // not initialized yet
+  lua_pushlightuserdata(L, (char *)name);
+  if (lua_rawget(L, -2) != LUA_TTABLE) {
+    lua_pop(L, 1); // nil
+    if (lua_getfield(L, LUA_REGISTRYINDEX, "ta_events") != LUA_TTABLE ||
+        lua_getfield(L, -1, name) != LUA_TTABLE)
+      return (lua_settop(L, top), FALSE);
+    lua_replace(L, -2); // ta_events
+    lua_pushlightuserdata(L, (char *)name), lua_pushvalue(L, -2);
+    lua_rawset(L, -4);
+  }
+  return (lua_replace(L, -2), TRUE); // ta_eventlists
+}
+
+/**
+ * Returns whether or not any handlers are connected to the given event.
+ * @param L The Lua state.
+ * @param name The event name.
+ */
+static int l_hashandlers(lua_State *L, const char *name) {
+  if (!l_pusheventhandlers(L, name)) return FALSE;
+  size_t num_handlers = lua_rawlen(L, -1);
+  return (lua_pop(L, 1), num_handlers > 0); // handlers
+}
+
+/**
+ * Returns the current value of a monotonic clock in nanoseconds.
+ * Only differences between values are meaningful.
+ */
+static long long l_nanotime() {
+#if __APPLE__
+  // Older versions of OSX do not have clock_gettime().
+  static mach_timebase_info_data_t timebase;
+  if (!timebase.denom) mach_timebase_info(&timebase);
+  return (long long)(mach_absolute_time() * ((double)timebase.numer /
+                                             timebase.denom));
+#elif !_WIN32
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+#else
+  LARGE_INTEGER count, frequency;
+  QueryPerformanceCounter(&count), QueryPerformanceFrequency(&frequency);
+  return (long long)(count.QuadPart * (1e9 / frequency.QuadPart));
+#endif
+}
+
+/** Returns the current value of a monotonic clock in seconds. */
+static double l_now() { return l_nanotime() / 1e9; }
+
+/**
+ * Begins a trace span if tracing is enabled.
+ * Spans must be finished in reverse order with trace_finish().
+ * @param category The span's category.
+ * @param name The span's name.
+ * @param msg The Scintilla message sent during the span, if any.
+ */
+static void trace_begin(const char *category, const char *name, int msg) {
+  if (!tracing || num_open_spans++ >= MAX_OPEN_SPANS) return;
+  Span *span = &open_spans[num_open_spans - 1];
+  strncpy(span->name, name, sizeof(span->name) - 1);
+  span->name[sizeof(span->name) - 1] = '\0';
+  span->category = category, span->msg = msg, span->start = l_nanotime();
+}
+
+/**
+ * Finishes the most recently begun trace span and records it in the ring
+ * buffer of spans, overwriting the oldest span if the buffer is full.
+ */
+static void trace_finish() {
+  if (!tracing || num_open_spans == 0 || --num_open_spans >= MAX_OPEN_SPANS)
+    return;
+  Span *span = &open_spans[num_open_spans];
+  span->duration = l_nanotime() - span->start;
+  spans[num_spans++ % max_spans] = *span;
+}
+
+#if LUA_VERSION_NUM >= 502
+/**
+ * Lua allocator that counts allocations before calling Lua's default one.
+ * LuaJIT does not support custom allocators, so allocations are not counted.
+ */
+static void *l_alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
+  if (nsize > 0 && (!ptr || nsize > osize)) alloc_count++;
+  return default_alloc(ud, ptr, osize, nsize);
+}
+#endif
+
+/**
+ * Adds the given elapsed time and number of allocations for a call to the
+ * statistics table at the top of the stack.
+ * @param L The Lua state.
+ * @param time The call's elapsed time in seconds.
+ * @param allocs The number of allocations made during the call.
+ * @param slow Whether or not the call exceeded `events.slow_handler_time`.
+ */
+static void l_addstats(lua_State *L, double time, size_t allocs, int slow) {
+  lua_getfield(L, -1, "calls");
+  lua_pushinteger(L, lua_tointeger(L, -1) + 1), lua_setfield(L, -3, "calls");
+  lua_getfield(L, -2, "time");
+  lua_pushnumber(L, lua_tonumber(L, -1) + time), lua_setfield(L, -4, "time");
+  lua_getfield(L, -3, "max_time");
+  if (time > lua_tonumber(L, -1))
+    lua_pushnumber(L, time), lua_setfield(L, -5, "max_time");
+  lua_getfield(L, -4, "allocs");
+  lua_pushinteger(L, lua_tointeger(L, -1) + allocs);
+  lua_setfield(L, -6, "allocs");
+  lua_getfield(L, -5, "slow");
+  lua_pushinteger(L, lua_tointeger(L, -1) + slow), lua_setfield(L, -7, "slow");
+  lua_pop(L, 5); // slow, allocs, max_time, time, calls
+}
+
+/**
+ * Pushes onto the stack the statistics table for the given event or, if
+ * *handler* is non-zero, for the handler at that stack index connected to that
+ * event, creating tables as needed.
+ * Tables live in the 'ta_eventstats' registry table (`events._stats`).
+ * @param L The Lua state.
+ * @param name The event name.
+ * @param handler The stack index of the handler, or 0.
+ */
+static void l_pusheventstats(lua_State *L, const char *name, int handler) {
+  lua_getfield(L, LUA_REGISTRYINDEX, "ta_eventstats");
+  if (lua_getfield(L, -1, name) != LUA_TTABLE) {
+    lua_pop(L, 1); // nil
+    lua_newtable(L), lua_newtable(L), lua_setfield(L, -2, "handlers");
+    lua_pushvalue(L, -1), lua_setfield(L, -3, name);
+  }
+  lua_replace(L, -2); // ta_eventstats
+  if (!handler) return;
+  lua_getfield(L, -1, "handlers"), lua_replace(L, -2);
+  lua_pushvalue(L, handler);
+  if (lua_rawget(L, -2) != LUA_TTABLE) {
+    lua_pop(L, 1); // nil
+    lua_newtable(L), lua_pushvalue(L, handler), lua_pushvalue(L, -2);
+    lua_rawset(L, -4);
+  }
+  lua_replace(L, -2); // handlers
+}
+
+/**
+ * Calls in order the event handlers in the list at the given stack index with
+ * the given arguments.
+ * As with `events.emit()`, errors in handlers are emitted as 'error' events and
+ * handlers that return a boolean value stop the event's propagation.
+ * If `events.profile` is `true`, collects call counts, elapsed times, and
+ * allocation counts for the event and each of its handlers. Handlers of
+ * 'keypress' and 'update_ui' events that take longer than
+ * `events.slow_handler_time` milliseconds are reported as 'error' events.
+ * @param L The Lua state.
+ * @param name The event name.
+ * @param list The stack index of the list of handlers.
+ * @param arg The stack index of the first argument to pass to handlers.
+ * @param n The number of arguments to pass to handlers.
+ * @return -1 if no handler returned a boolean value, or that value.
+ */
+static int l_callhandlers(lua_State *L, const char *name, int list, int arg,
+                          int n) {
+  static int error_emitted;
+  int ret = -1, top = lua_gettop(L), profile = profile_events;
+  double slow_time = 0, total_time = 0;
+  size_t total_allocs = 0;
+  if (slow_handler_time > 0 &&
+      (strcmp(name, "keypress") == 0 || strcmp(name, "update_ui") == 0))
+    slow_time = slow_handler_time / 1000.0;
+  trace_begin("event", name, 0);
+  // Note: stop at the first non-function, as disconnecting a handler during
+  // emission shifts the list.
+  for (int i = 1; lua_rawgeti(L, list, i) == LUA_TFUNCTION; i++) {
+    lua_pushvalue(L, -1); // keep handler for statistics
+    for (int j = 0; j < n; j++) lua_pushvalue(L, arg + j);
+    double start = (profile || slow_time > 0) ? l_now() : 0;
+    size_t allocs = alloc_count;
+    int status = lua_pcall(L, n, 1, 0);
+    if (profile || slow_time > 0) {
+      double time = l_now() - start;
+      int slow = slow_time > 0 && time > slow_time;
+      if (slow) {
+        lua_Debug ar;
+        lua_pushvalue(L, -2), lua_getinfo(L, ">S", &ar);
+        lua_pushfstring(L, "slow '%s' handler (%s:%d): %dms", name,
+                        ar.short_src, ar.linedefined, (int)(time * 1000));
+        if (!error_emitted) {
+          error_emitted = TRUE;
+          lL_event(L, "error", LUA_TSTRING, lua_tostring(L, -1), -1);
+          error_emitted = FALSE;
+        } else fprintf(stderr, "%s\n", lua_tostring(L, -1));
+        lua_pop(L, 1); // message
+      }
+      if (profile) {
+        l_pusheventstats(L, name, top + 1);
+        l_addstats(L, time, alloc_count - allocs, slow), lua_pop(L, 1);
+        total_time += time, total_allocs += alloc_count - allocs;
+      }
+    }
+    if (status != LUA_OK) {
+      if (!error_emitted) {
+        error_emitted = TRUE;
+        lL_event(L, "error", LUA_TSTRING, lua_tostring(L, -1), -1);
+        error_emitted = FALSE;
+      } else fprintf(stderr, "%s", lua_tostring(L, -1));
+    } else if (lua_isboolean(L, -1)) {
+      ret = lua_toboolean(L, -1);
+      break;
+    }
+    lua_settop(L, top); // result or error, handler
+  }
+  lua_settop(L, top);
+  if (profile) {
+    l_pusheventstats(L, name, 0);
+    l_addstats(L, total_time, total_allocs, FALSE), lua_pop(L, 1);
+  }
+  trace_finish();
+  return ret;
+}
+
 /**
  * Emits an event.
+ * Handlers are called directly rather than through `events.emit()`.
  * @param L The Lua state.
  * @param name The event name.
  * @param ... Arguments to pass with the event. Each pair of arguments should be
@@ -257,38 +611,48 @@ LUALIB_API int lspawn_pushfds(lua_State *), lspawn_readfds(lua_State *);
  *   must be terminated with a -1.
  * @return TRUE or FALSE depending on the boolean value returned by the event
  *   handler, if any.
+ * @see l_callhandlers
  */
 static int lL_event(lua_State *L, const char *name, ...) {
-  int ret = FALSE;
-  if (lua_getglobal(L, "events") == LUA_TTABLE) {
-    if (lua_getfield(L, -1, "emit") == LUA_TFUNCTION) {
-      lua_pushstring(L, name);
-      int n = 1, type;
-      va_list ap;
-      va_start(ap, name);
-      for (type = va_arg(ap, int); type != -1; type = va_arg(ap, int), n++)
-        if (type == LUA_TNIL)
-          lua_pushnil(L);
-        else if (type == LUA_TBOOLEAN)
-          lua_pushboolean(L, va_arg(ap, int));
-        else if (type == LUA_TNUMBER)
-          lua_pushinteger(L, va_arg(ap, int));
-        else if (type == LUA_TSTRING)
-          lua_pushstring(L, va_arg(ap, char *));
-        else if (type == LUA_TLIGHTUSERDATA || type == LUA_TTABLE) {
-          sptr_t arg = va_arg(ap, sptr_t);
-          lua_rawgeti(L, LUA_REGISTRYINDEX, arg);
-          luaL_unref(L, LUA_REGISTRYINDEX, arg);
-        }
-      va_end(ap);
-      if (lua_pcall(L, n, 1, 0) == LUA_OK)
-        ret = lua_toboolean(L, -1);
-      else
-        lL_event(L, "error", LUA_TSTRING, lua_tostring(L, -1), -1);
-      lua_pop(L, 2); // result, events
-    } else lua_pop(L, 2); // non-function, events
-  } else lua_pop(L, 1); // non-table
-  return ret;
+  int top = lua_gettop(L), n = 0, type;
+  va_list ap;
+  va_start(ap, name);
+  for (type = va_arg(ap, int); type != -1; type = va_arg(ap, int), n++)
+    if (type == LUA_TNIL)
+      lua_pushnil(L);
+    else if (type == LUA_TBOOLEAN)
+      lua_pushboolean(L, va_arg(ap, int));
+    else if (type == LUA_TNUMBER)
+      lua_pushinteger(L, va_arg(ap, int));
+    else if (type == LUA_TSTRING)
+      lua_pushstring(L, va_arg(ap, char *));
+    else if (type == LUA_TLIGHTUSERDATA || type == LUA_TTABLE) {
+      sptr_t arg = va_arg(ap, sptr_t);
+      lua_rawgeti(L, LUA_REGISTRYINDEX, arg);
+      luaL_unref(L, LUA_REGISTRYINDEX, arg);
+    }
+  va_end(ap);
+  if (!l_pusheventhandlers(L, name)) return (lua_settop(L, top), FALSE);
+  int ret = l_callhandlers(L, name, top + n + 1, top + 1, n);
+  lua_settop(L, top);
+  return ret > 0;
+}
+
+/** `events._monitor()` Lua function. */
+static int levents__monitor(lua_State *L) {
+  profile_events = lua_toboolean(L, 1);
+  slow_handler_time = luaL_optnumber(L, 2, 0);
+  return 0;
+}
+
+/** `events._emit()` Lua function. */
+static int levents__emit(lua_State *L) {
+  const char *name = luaL_checkstring(L, 1);
+  int n = lua_gettop(L) - 1;
+  lua_getfield(L, LUA_REGISTRYINDEX, "ta_events"), lua_pushvalue(L, 1);
+  if (lua_rawget(L, -2) != LUA_TTABLE) return 0;
+  int ret = l_callhandlers(L, name, n + 3, 2, n);
+  return ret < 0 ? 0 : (lua_pushboolean(L, ret), 1);
 }
 
 #if GTK
@@ -986,29 +1350,74 @@ static sptr_t l_todoc(lua_State *L, int index) {
 }
 
 /**
- * Compares the Scintilla document at the given index with the global one and
- * returns 0 if they are equivalent, less than zero if that document belongs to
- * the command entry, and greater than zero otherwise.
- * In the last case, loads the document in `dummy_view` for non-global document
- * use (unless it is already loaded). Raises and error if the value is not a
- * Scintilla document or if the document no longer exists.
+ * Removes the `_load` function of the buffer at the given index, if it has one,
+ * and optionally calls it with the buffer.
+ * Session placeholder buffers are created empty with a `_load` function that
+ * fills them the first time they are used with Scintilla. Errors in that
+ * function are emitted as 'error' events rather than raised from whatever
+ * buffer access triggered the load.
+ * @param L The Lua state.
+ * @param index The stack index of the buffer.
+ * @param load Whether or not to call the buffer's `_load` function. Deleted
+ *   buffers are never loaded.
+ */
+static void lL_loadbuffer(lua_State *L, int index, int load) {
+  if (index < 0) index = lua_gettop(L) + index + 1;
+  lua_pushstring(L, "_load");
+  if (lua_rawget(L, index) == LUA_TFUNCTION) {
+    lua_pushstring(L, "_load"), lua_pushnil(L), lua_rawset(L, index);
+    if (load) {
+      lua_pushvalue(L, index);
+      if (lua_pcall(L, 1, 0, 0) != LUA_OK)
+        lL_event(L, "error", LUA_TSTRING, lua_tostring(L, -1), -1),
+          lua_pop(L, 1); // error
+      return;
+    }
+  }
+  lua_pop(L, 1); // _load
+}
+
+/**
+ * Returns the Scintilla view to use for operating on the Scintilla document at
+ * the given index.
+ * This is the focused view if the document is the global one, the command entry
+ * if the document belongs to it, or, for queries, another view if one already
+ * shows the document. Otherwise the document is loaded into `dummy_view` for
+ * non-global document use (unless it is already loaded). Since loading a
+ * document resets a view's state and layout data, reusing views avoids
+ * reloading as much as possible. Only queries go through other visible views,
+ * since other calls could move the selection or scroll position the user sees.
+ * Raises an error if the value is not a Scintilla document or if the document
+ * no longer exists. Placeholder buffers are loaded first.
  * @param L The Lua state.
  * @param index The stack index of the Scintilla document.
- * @return 0, -1, or the Scintilla document's pointer
+ * @param query Whether or not the view is only used to query the document.
+ * @return Scintilla view
+ * @see lL_loadbuffer
  */
-static sptr_t l_globaldoccompare(lua_State *L, int index) {
+static Scintilla *l_globaldocview(lua_State *L, int index, int query) {
   luaL_argcheck(L, lL_hasmetatable(L, index, "ta_buffer"), index,
                 "Buffer expected");
+  lL_loadbuffer(L, index, TRUE);
   sptr_t doc = l_todoc(L, index);
-  if (doc != SS(focused_view, SCI_GETDOCPOINTER, 0, 0)) {
-    lua_getfield(L, LUA_REGISTRYINDEX, "ta_buffers");
-    luaL_argcheck(L, (l_pushdoc(L, doc), lua_gettable(L, -2) != LUA_TNIL),
-                  index, "this Buffer does not exist");
-    lua_pop(L, 2); // buffer, ta_buffers
-    if (doc == SS(command_entry, SCI_GETDOCPOINTER, 0, 0)) return -1;
-    if (doc == SS(dummy_view, SCI_GETDOCPOINTER, 0, 0)) return doc; // keep
-    return (SS(dummy_view, SCI_SETDOCPOINTER, 0, doc), doc);
-  } else return 0;
+  if (doc == SS(focused_view, SCI_GETDOCPOINTER, 0, 0)) return focused_view;
+  lua_getfield(L, LUA_REGISTRYINDEX, "ta_buffers");
+  luaL_argcheck(L, (l_pushdoc(L, doc), lua_gettable(L, -2) != LUA_TNIL),
+                index, "this Buffer does not exist");
+  lua_pop(L, 2); // buffer, ta_buffers
+  if (doc == SS(command_entry, SCI_GETDOCPOINTER, 0, 0)) return command_entry;
+  if (doc == dummy_doc) return dummy_view; // keep
+  if (query) {
+    lua_getfield(L, LUA_REGISTRYINDEX, "ta_views");
+    for (size_t i = 1; i <= lua_rawlen(L, -1); i++) {
+      Scintilla *view = (lua_rawgeti(L, -1, i), l_toview(L, -1));
+      lua_pop(L, 1); // view
+      if (doc == SS(view, SCI_GETDOCPOINTER, 0, 0))
+        return (lua_pop(L, 1), view);
+    }
+    lua_pop(L, 1); // views
+  }
+  return (SS(dummy_view, SCI_SETDOCPOINTER, 0, dummy_doc = doc), dummy_view);
 }
 
 /**
@@ -1036,10 +1445,12 @@ static void lL_gotodoc(lua_State *L, Scintilla *view, int n, int relative) {
                   "no Buffer exists at that index");
     lua_rawgeti(L, -1, (n > 0) ? n : (int)lua_rawlen(L, -1));
   }
+  trace_begin("buffer", "goto_doc", 0);
   sptr_t doc = l_todoc(L, -1);
   SS(view, SCI_SETDOCPOINTER, 0, doc), sync_tabbar();
   l_setglobaldoc(L, doc);
   lua_pop(L, 2); // buffer and buffers
+  trace_finish();
 }
 
 /**
@@ -1062,8 +1473,9 @@ static void register_command_entry_doc() {
 }
 
 /**
- * Removes the Scintilla document from the 'buffers' registry table.
+ * Removes the Scintilla document from the 'buffers' registry table in place.
  * The document must have been previously added with lL_adddoc.
+ * Only the buffers after the removed one are renumbered.
  * It is removed from any other views showing it first. Therefore, ensure the
  * length of 'buffers' is more than one unless quitting the application.
  * @param L The Lua state.
@@ -1071,6 +1483,17 @@ static void register_command_entry_doc() {
  * @see lL_adddoc
  */
 static void lL_removedoc(lua_State *L, sptr_t doc) {
+  for (int i = num_modified_ranges - 1; i >= 0; i--)
+    if (modified_ranges[i].doc == doc)
+      memmove(modified_ranges + i, modified_ranges + i + 1,
+              (--num_modified_ranges - i) * sizeof(ModifiedRange));
+  for (int i = num_bulk_scopes - 1; i >= 0; i--)
+    if (bulk_scopes[i].doc == doc)
+      memmove(bulk_scopes + i, bulk_scopes + i + 1,
+              (--num_bulk_scopes - i) * sizeof(BulkScope));
+  lua_getfield(L, LUA_REGISTRYINDEX, "ta_bufferps");
+  l_pushdoc(L, doc), lua_pushnil(L), lua_rawset(L, -3);
+  lua_pop(L, 1); // ta_bufferps
   lua_getfield(L, LUA_REGISTRYINDEX, "ta_views");
   for (size_t i = 1; i <= lua_rawlen(L, -1); i++) {
     lua_rawgeti(L, -1, i);
@@ -1079,29 +1502,31 @@ static void lL_removedoc(lua_State *L, sptr_t doc) {
     lua_pop(L, 1); // value
   }
   lua_pop(L, 1); // views
-  lua_newtable(L);
   lua_getfield(L, LUA_REGISTRYINDEX, "ta_buffers");
-  for (size_t i = 1; i <= lua_rawlen(L, -1); i++)
-    if (doc != (lua_rawgeti(L, -1, i), l_todoc(L, -1))) {
-      lua_getfield(L, -1, "doc_pointer");
-      // t[doc_pointer] = buffer, t[#t + 1] = buffer, t[buffer] = #t
-      lua_pushvalue(L, -2), lua_rawseti(L, -5, lua_rawlen(L, -5) + 1);
-      lua_pushvalue(L, -2), lua_settable(L, -5);
-      lua_pushinteger(L, lua_rawlen(L, -3)), lua_settable(L, -4);
-    } else {
+  int n = lua_rawlen(L, -1);
+  lua_pushlightuserdata(L, (sptr_t *)doc), lua_rawget(L, -2);
+  lua_pushvalue(L, -1), lua_rawget(L, -3);
+  int i = lua_tointeger(L, -1);
+  lua_pop(L, 1); // index
+  // t[doc_pointer] = nil, t[buffer] = nil
+  lua_pushnil(L), lua_rawset(L, -3);
+  lua_pushlightuserdata(L, (sptr_t *)doc), lua_pushnil(L), lua_rawset(L, -3);
+  // Shift subsequent buffers down: t[j - 1] = buffer, t[buffer] = j - 1.
+  // Closing the last buffer, as io.close_all_buffers() does, shifts nothing.
+  for (int j = i + 1; j <= n; j++) {
+    lua_rawgeti(L, -1, j), lua_pushvalue(L, -1), lua_rawseti(L, -3, j - 1);
+    lua_pushinteger(L, j - 1), lua_rawset(L, -3);
+  }
+  lua_pushnil(L), lua_rawseti(L, -2, n);
+  lua_pop(L, 1); // buffers
 #if GTK
-      // Remove the tab from the tabbar.
-      gtk_notebook_remove_page(GTK_NOTEBOOK(tabbar), i - 1);
-      gtk_widget_set_visible(tabbar, show_tabs && lua_rawlen(L, -2) > 2);
+  // Remove the tab from the tabbar.
+  gtk_notebook_remove_page(GTK_NOTEBOOK(tabbar), i - 1);
+  gtk_widget_set_visible(tabbar, show_tabs &&
+                         gtk_notebook_get_n_pages(GTK_NOTEBOOK(tabbar)) > 1);
 //#elif CURSES
-      // TODO: tabs
+  // TODO: tabs
 #endif
-      lua_pop(L, 1); // buffer
-    }
-  lua_pop(L, 1); // buffers
-  lua_pushvalue(L, -1), lua_setfield(L, LUA_REGISTRYINDEX, "ta_buffers");
-  register_command_entry_doc();
-  lua_setglobal(L, "_BUFFERS");
 }
 
 /**
@@ -1110,19 +1535,22 @@ static void lL_removedoc(lua_State *L, sptr_t doc) {
  * @see lL_removedoc
  */
 static void delete_buffer(sptr_t doc) {
-  lL_removedoc(lua, doc), SS(dummy_view, SCI_SETDOCPOINTER, 0, 0);
+  lL_removedoc(lua, doc), SS(dummy_view, SCI_SETDOCPOINTER, 0, dummy_doc = 0);
   SS(focused_view, SCI_RELEASEDOCUMENT, 0, doc);
 }
 
 /** `buffer.delete()` Lua function. */
 static int lbuffer_delete(lua_State *L) {
-  Scintilla *view = l_globaldoccompare(L, 1) == 0 ? focused_view : dummy_view;
-  sptr_t doc = SS(view, SCI_GETDOCPOINTER, 0, 0);
+  if (lL_hasmetatable(L, 1, "ta_buffer")) lL_loadbuffer(L, 1, FALSE);
+  sptr_t doc = SS(l_globaldocview(L, 1, TRUE), SCI_GETDOCPOINTER, 0, 0);
+  // Only switch away from the buffer if it is the current one.
+  int current = doc == SS(focused_view, SCI_GETDOCPOINTER, 0, 0);
   lua_getfield(L, LUA_REGISTRYINDEX, "ta_buffers");
   if (lua_rawlen(L, -1) == 1) new_buffer(0);
-  lL_gotodoc(L, focused_view, -1, TRUE);
+  if (current) lL_gotodoc(L, focused_view, -1, TRUE);
   delete_buffer(doc);
-  lL_event(L, "buffer_after_switch", -1), lL_event(L, "buffer_deleted", -1);
+  if (current) lL_event(L, "buffer_after_switch", -1);
+  lL_event(L, "buffer_deleted", -1);
   return 0;
 }
 
@@ -1133,6 +1561,215 @@ static int lbuffer_new(lua_State *L) {
   return (lua_rawgeti(L, -1, lua_rawlen(L, -1)), 1);
 }
 
+/**
+ * Sends a message to a Scintilla view through its direct function, bypassing
+ * `scintilla_send_message()`'s widget type checks and dispatch.
+ * The direct functions and pointers of the most recently used views are cached.
+ * @param view The Scintilla view.
+ * @param msg The Scintilla message.
+ * @param wparam The message's wParam.
+ * @param lparam The message's lParam.
+ * @return Scintilla result
+ * @see clear_directs
+ */
+static sptr_t send_direct(Scintilla *view, int msg, uptr_t wparam,
+                          sptr_t lparam) {
+  static int next;
+  int i = 0;
+  while (i < 4 && directs[i].view != view) i++;
+  if (i == 4) {
+    i = next, next = (next + 1) % 4;
+    directs[i].view = view;
+    directs[i].f = (SciFnDirect)SS(view, SCI_GETDIRECTFUNCTION, 0, 0);
+    directs[i].ptr = SS(view, SCI_GETDIRECTPOINTER, 0, 0);
+  }
+  if (!directs[i].f) return SS(view, msg, wparam, lparam); // unsupported
+  return directs[i].f(directs[i].ptr, msg, wparam, lparam);
+}
+
+/**
+ * Clears the cache of Scintilla views' direct functions and pointers.
+ * This must be done whenever a view is deleted.
+ * @see send_direct
+ */
+static void clear_directs() { memset(directs, 0, sizeof(directs)); }
+
+/**
+ * Returns the text of the slice at the given stack index and stores its length
+ * in len.
+ * The returned pointer points directly into the slice's Scintilla document and
+ * is only valid until the next call to Scintilla. Raises an error if the value
+ * is not a slice, if its document no longer exists, or if any text has been
+ * modified since the slice was created.
+ * @param L The Lua state.
+ * @param index The stack index of the slice.
+ * @param len Pointer to store the slice's length in.
+ * @return text
+ */
+static const char *lL_checkslice(lua_State *L, int index, size_t *len) {
+  Slice *slice = (Slice *)luaL_checkudata(L, index, "ta_slice");
+  luaL_argcheck(L, slice->version == text_version, index,
+                "Slice invalidated by text modification");
+  luaL_argcheck(L, (l_pushdoc(L, slice->doc), lua_istable(L, -1)), index,
+                "this Buffer does not exist");
+  Scintilla *view = l_globaldocview(L, -1, TRUE);
+  lua_pop(L, 1); // buffer
+  *len = slice->length;
+  if (*len == 0) return "";
+  return (const char *)send_direct(view, SCI_GETRANGEPOINTER, slice->start,
+                                   *len);
+}
+
+/**
+ * Pushes onto the stack a string copy of the slice at the given stack index.
+ * The copy is made once and reused for the life of the slice.
+ * @param L The Lua state.
+ * @param index The stack index of the slice.
+ */
+static void l_pushslicestring(lua_State *L, int index) {
+  size_t len;
+  const char *text = lL_checkslice(L, index, &len);
+  Slice *slice = (Slice *)lua_touserdata(L, index);
+  if (slice->ref != LUA_NOREF) {
+    lua_rawgeti(L, LUA_REGISTRYINDEX, slice->ref);
+    return;
+  }
+  lua_pushlstring(L, text, len), lua_pushvalue(L, -1);
+  slice->ref = luaL_ref(L, LUA_REGISTRYINDEX);
+}
+
+/**
+ * Returns the 1-based string position pos relative to a string of length len,
+ * with negative positions counting from the end of the string.
+ * @param pos The position.
+ * @param len The length of the string.
+ * @return position
+ */
+static size_t l_posrelat(lua_Integer pos, size_t len) {
+  if (pos >= 0) return (size_t)pos;
+  return (0u - (size_t)pos > len) ? 0 : len + (size_t)pos + 1;
+}
+
+/**
+ * Calls the `string` library function with the given name, passing it a string
+ * copy of the slice at stack index 1 and the remaining arguments, and returns
+ * that function's results.
+ * This is needed for pattern matching, since Lua and LPeg only match strings.
+ * @param L The Lua state.
+ * @param name The name of the `string` library function to call.
+ * @return number of results pushed onto the stack.
+ */
+static int l_callslicestring(lua_State *L, const char *name) {
+  l_pushslicestring(L, 1), lua_replace(L, 1);
+  lua_getglobal(L, "string"), lua_getfield(L, -1, name), lua_replace(L, -2);
+  lua_insert(L, 1), lua_call(L, lua_gettop(L) - 1, LUA_MULTRET);
+  return lua_gettop(L);
+}
+
+/** `slice.sub()` Lua function. */
+static int lslice_sub(lua_State *L) {
+  size_t len;
+  const char *text = lL_checkslice(L, 1, &len);
+  size_t i = l_posrelat(luaL_optinteger(L, 2, 1), len);
+  size_t j = l_posrelat(luaL_optinteger(L, 3, -1), len);
+  if (i < 1) i = 1;
+  if (j > len) j = len;
+  if (i > j) return (lua_pushliteral(L, ""), 1);
+  return (lua_pushlstring(L, text + i - 1, j - i + 1), 1);
+}
+
+/** `slice.byte()` Lua function. */
+static int lslice_byte(lua_State *L) {
+  size_t len;
+  const char *text = lL_checkslice(L, 1, &len);
+  size_t i = l_posrelat(luaL_optinteger(L, 2, 1), len);
+  size_t j = l_posrelat(luaL_optinteger(L, 3, i), len);
+  if (i < 1) i = 1;
+  if (j > len) j = len;
+  if (i > j) return 0;
+  luaL_checkstack(L, j - i + 1, "string slice too long");
+  for (size_t k = i - 1; k < j; k++) lua_pushinteger(L, (unsigned char)text[k]);
+  return j - i + 1;
+}
+
+/** `slice.find()` Lua function. */
+static int lslice_find(lua_State *L) {
+  size_t len, plen;
+  const char *patt = luaL_checklstring(L, 2, &plen);
+  if (!lua_toboolean(L, 4) && strpbrk(patt, "^$*+?.([%-"))
+    return l_callslicestring(L, "find"); // Lua pattern
+  // Plain text search directly over the document's memory.
+  const char *text = lL_checkslice(L, 1, &len);
+  size_t init = l_posrelat(luaL_optinteger(L, 3, 1), len);
+  if (init < 1) init = 1;
+  if (init > len + 1) return (lua_pushnil(L), 1);
+  for (const char *p = text + init - 1; p + plen <= text + len; p++)
+    if (memcmp(p, patt, plen) == 0) {
+      lua_pushinteger(L, p - text + 1), lua_pushinteger(L, p - text + plen);
+      return 2;
+    }
+  return (lua_pushnil(L), 1);
+}
+
+/** `slice.match()` Lua function. */
+static int lslice_match(lua_State *L) {
+  if (lua_type(L, 2) == LUA_TSTRING) return l_callslicestring(L, "match");
+  // LPeg pattern.
+  l_pushslicestring(L, 1), lua_replace(L, 1);
+  lua_getglobal(L, "lpeg"), lua_getfield(L, -1, "match"), lua_replace(L, -2);
+  lua_insert(L, 1), lua_pushvalue(L, 2), lua_pushvalue(L, 3);
+  lua_replace(L, 2), lua_replace(L, 3); // lpeg.match(patt, text, ...)
+  lua_call(L, lua_gettop(L) - 1, LUA_MULTRET);
+  return lua_gettop(L);
+}
+
+/** `slice.gmatch()` Lua function. */
+static int lslice_gmatch(lua_State *L) {return l_callslicestring(L, "gmatch");}
+
+/** `slice.__len` Lua metamethod. */
+static int lslice__len(lua_State *L) {
+  size_t len;
+  return (lL_checkslice(L, 1, &len), lua_pushinteger(L, len), 1);
+}
+
+/** `slice.__tostring` Lua metamethod. */
+static int lslice__tostring(lua_State *L) {
+  return (l_pushslicestring(L, 1), 1);
+}
+
+/** `slice.__gc` Lua metamethod. */
+static int lslice__gc(lua_State *L) {
+  luaL_unref(L, LUA_REGISTRYINDEX, ((Slice *)lua_touserdata(L, 1))->ref);
+  return 0;
+}
+
+/** `buffer.slice()` Lua function. */
+static int lbuffer_slice(lua_State *L) {
+  Scintilla *view = l_globaldocview(L, 1, TRUE);
+  int length = send_direct(view, SCI_GETLENGTH, 0, 0);
+  int start = luaL_optinteger(L, 2, 0), end = luaL_optinteger(L, 3, length);
+  if (start < 0) start = 0;
+  if (end > length) end = length;
+  Slice *slice = (Slice *)lua_newuserdata(L, sizeof(Slice));
+  slice->doc = send_direct(view, SCI_GETDOCPOINTER, 0, 0);
+  slice->start = start, slice->length = (end > start) ? end - start : 0;
+  slice->version = text_version, slice->ref = LUA_NOREF;
+  if (luaL_newmetatable(L, "ta_slice")) {
+    l_setcfunction(L, -1, "__len", lslice__len);
+    l_setcfunction(L, -1, "__tostring", lslice__tostring);
+    l_setcfunction(L, -1, "__gc", lslice__gc);
+    lua_newtable(L);
+    l_setcfunction(L, -1, "byte", lslice_byte);
+    l_setcfunction(L, -1, "find", lslice_find);
+    l_setcfunction(L, -1, "gmatch", lslice_gmatch);
+    l_setcfunction(L, -1, "match", lslice_match);
+    l_setcfunction(L, -1, "sub", lslice_sub);
+    lua_setfield(L, -2, "__index");
+  }
+  lua_setmetatable(L, -2);
+  return 1;
+}
+
 /**
  * Checks whether the function argument arg is the given Scintilla parameter
  * type and returns it cast to the proper type.
@@ -1148,6 +1785,94 @@ static sptr_t lL_checkscintillaparam(lua_State *L, int *arg, int type) {
   return 0;
 }
 
+/**
+ * Returns the open bulk or undo action scopes for the given document or `NULL`.
+ * @param doc The Scintilla document.
+ */
+static BulkScope *bulk_scope(sptr_t doc) {
+  for (int i = 0; i < num_bulk_scopes; i++)
+    if (bulk_scopes[i].doc == doc) return &bulk_scopes[i];
+  return NULL;
+}
+
+/**
+ * Returns the number of open bulk or undo action scopes for the given document.
+ * @param doc The Scintilla document.
+ */
+static int bulk_depth(sptr_t doc) {
+  BulkScope *scope = bulk_scope(doc);
+  return scope ? scope->depth : 0;
+}
+
+/**
+ * Opens a bulk scope for the given document.
+ * @param doc The Scintilla document.
+ * @param undo Whether or not the scope is an undo action.
+ * @see end_bulk
+ */
+static void begin_bulk(sptr_t doc, int undo) {
+  BulkScope *scope = bulk_scope(doc);
+  if (!scope) {
+    if (num_bulk_scopes == max_bulk_scopes) {
+      max_bulk_scopes = max_bulk_scopes ? max_bulk_scopes * 2 : 4;
+      bulk_scopes = realloc(bulk_scopes, max_bulk_scopes * sizeof(BulkScope));
+    }
+    scope = &bulk_scopes[num_bulk_scopes++];
+    scope->doc = doc, scope->depth = 0, scope->undo_depth = 0;
+  }
+  scope->depth++;
+  if (undo) scope->undo_depth++;
+}
+
+/**
+ * Closes a bulk scope opened for the given document, if any.
+ * @param doc The Scintilla document.
+ * @param undo Whether or not the scope is an undo action.
+ * @see begin_bulk
+ */
+static void end_bulk(sptr_t doc, int undo) {
+  BulkScope *scope = bulk_scope(doc);
+  if (!scope) return;
+  if (undo && scope->undo_depth > 0) scope->undo_depth--;
+  if (--scope->depth == 0) {
+    int i = scope - bulk_scopes;
+    memmove(bulk_scopes + i, bulk_scopes + i + 1,
+            (--num_bulk_scopes - i) * sizeof(BulkScope));
+  }
+}
+
+/**
+ * Emits a 'modified_range' event for each coalesced text modification range
+ * whose document has no open bulk modification scope.
+ * This is called when a document's outermost scope ends and from the main loop,
+ * so handlers never run in the middle of other Lua code's modifications.
+ * Events are emitted with the modified range's start and end positions, net
+ * number of lines added, and buffer.
+ * @param L The Lua state.
+ * @param doc The Scintilla document whose range to emit, or 0 for all of them.
+ */
+static void lL_emitmodifiedranges(lua_State *L, sptr_t doc) {
+  static int emitting;
+  if (!num_modified_ranges || emitting) return;
+  emitting = TRUE;
+  // Note: handlers may modify text, adding ranges.
+  for (int i = 0; i < num_modified_ranges;) {
+    if ((doc && modified_ranges[i].doc != doc) ||
+        bulk_depth(modified_ranges[i].doc)) {
+      i++;
+      continue;
+    }
+    ModifiedRange range = modified_ranges[i];
+    memmove(modified_ranges + i, modified_ranges + i + 1,
+            (--num_modified_ranges - i) * sizeof(ModifiedRange));
+    l_pushdoc(L, range.doc);
+    lL_event(L, "modified_range", LUA_TNUMBER, range.start, LUA_TNUMBER,
+             range.end, LUA_TNUMBER, range.lines_added, LUA_TTABLE,
+             luaL_ref(L, LUA_REGISTRYINDEX), -1);
+  }
+  emitting = FALSE;
+}
+
 /**
  * Calls a function as a Scintilla function.
  * Does not remove any arguments from the stack, but does push results.
@@ -1182,6 +1907,33 @@ static int l_callscintilla(lua_State *L, Scintilla *view, int msg, int wtype,
       ltype = SSTRING;
   }
 
+  // Push the text requested by these messages directly from the document's
+  // memory instead of having Scintilla copy it into a temporary buffer first.
+  if (msg == SCI_GETTEXT || msg == SCI_GETLINE || msg == SCI_GETTARGETTEXT ||
+      msg == SCI_GETTEXTRANGE) {
+    sptr_t start = 0, end = send_direct(view, SCI_GETLENGTH, 0, 0);
+    if (msg == SCI_GETLINE) {
+      int line = luaL_checkinteger(L, arg);
+      start = send_direct(view, SCI_POSITIONFROMLINE, line, 0);
+      end = start + send_direct(view, SCI_LINELENGTH, line, 0);
+    } else if (msg == SCI_GETTARGETTEXT) {
+      start = send_direct(view, SCI_GETTARGETSTART, 0, 0);
+      end = send_direct(view, SCI_GETTARGETEND, 0, 0);
+    } else if (msg == SCI_GETTEXTRANGE) {
+      int start_pos = luaL_checkinteger(L, arg);
+      int end_pos = luaL_checkinteger(L, arg + 1);
+      if (start_pos > start) start = start_pos;
+      if (end_pos < end) end = end_pos;
+    }
+    sptr_t len = (end > start) ? end - start : 0;
+    arg = lua_gettop(L);
+    const char *text = (len > 0) ? (const char *)send_direct(
+      view, SCI_GETRANGEPOINTER, start, len) : "";
+    lua_pushlstring(L, text, len);
+    if (msg == SCI_GETTEXT || msg == SCI_GETLINE) lua_pushinteger(L, len);
+    return lua_gettop(L) - arg;
+  }
+
   // Set wParam and lParam appropriately for Scintilla based on wtype and ltype.
   if (wtype == SLEN && ltype == SSTRING) {
     wparam = (uptr_t)lua_rawlen(L, arg);
@@ -1192,7 +1944,7 @@ static int l_callscintilla(lua_State *L, Scintilla *view, int msg, int wtype,
   if (params_needed > 0) wparam = lL_checkscintillaparam(L, &arg, wtype);
   if (params_needed > 1) lparam = lL_checkscintillaparam(L, &arg, ltype);
   if (string_return) { // create a buffer for the return string
-    len = SS(view, msg, wparam, 0);
+    len = send_direct(view, msg, wparam, 0);
     if (wtype == SLEN) wparam = len;
     text = malloc(len + 1), text[len] = '\0';
     if (msg == SCI_GETTEXT || msg == SCI_GETSELTEXT || msg == SCI_GETCURLINE)
@@ -1201,7 +1953,15 @@ static int l_callscintilla(lua_State *L, Scintilla *view, int msg, int wtype,
   }
 
   // Send the message to Scintilla and return the appropriate values.
-  sptr_t result = SS(view, msg, wparam, lparam);
+  trace_begin("scintilla", "", msg);
+  sptr_t result = send_direct(view, msg, wparam, lparam);
+  trace_finish();
+  if (msg == SCI_BEGINUNDOACTION)
+    begin_bulk(send_direct(view, SCI_GETDOCPOINTER, 0, 0), TRUE);
+  else if (msg == SCI_ENDUNDOACTION) {
+    sptr_t doc = send_direct(view, SCI_GETDOCPOINTER, 0, 0);
+    end_bulk(doc, TRUE), lL_emitmodifiedranges(L, doc);
+  }
   arg = lua_gettop(L);
   if (string_return) lua_pushlstring(L, text, len), free(text);
   if (rtype > SVOID && rtype < SBOOL)
@@ -1211,71 +1971,1003 @@ static int l_callscintilla(lua_State *L, Scintilla *view, int msg, int wtype,
   return lua_gettop(L) - arg;
 }
 
-static int lbuf_closure(lua_State *L) {
-  Scintilla *view = focused_view;
-  // If optional buffer/view argument is given, check it.
-  if (lua_istable(L, 1)) {
-    //if (lL_hasmetatable(L, 1, "ta_view"))
-    //  lua_getfield(L, 1, "buffer"), lua_replace(L, 1); // use view.buffer
-    int result = l_globaldoccompare(L, 1);
-    if (result != 0) view = (result > 0) ? dummy_view : command_entry;
-  }
-  // Interface table is of the form {msg, rtype, wtype, ltype}.
-  return l_callscintilla(L, view, l_rawgetiint(L, lua_upvalueindex(1), 1),
-                         l_rawgetiint(L, lua_upvalueindex(1), 3),
-                         l_rawgetiint(L, lua_upvalueindex(1), 4),
-                         l_rawgetiint(L, lua_upvalueindex(1), 2),
-                         lua_istable(L, 1) ? 2 : 1);
+/**
+ * Returns the seeded 32-bit FNV-1a hash of the given string.
+ * This must match `hash()` in scripts/gen_iface.lua.
+ * @param s The string to hash.
+ * @param seed The seed, or 0 for the default FNV offset basis.
+ */
+static unsigned int iface_hash(const char *s, int seed) {
+  unsigned int h = seed ? (unsigned int)seed : 2166136261u;
+  for (; *s; s++) h = (h ^ (unsigned char)*s) * 16777619u;
+  return h;
 }
 
-/** `buffer.__index` and `buffer.__newindex` Lua metamethods. */
-static int lbuf_property(lua_State *L) {
-  int newindex = (lua_gettop(L) == 3);
-  int is_buffer = lL_hasmetatable(L, 1, "ta_buffer"); // ta_buffer or ta_bufferp
+/**
+ * Returns the entry for the given name in the given compiled Scintilla
+ * interface table, or NULL if there is none.
+ * The table is a minimal perfect hash (see scripts/gen_iface.lua), so this
+ * takes one or two hashes and a single string comparison.
+ * @param table The interface table to search.
+ * @param name The name to look up.
+ */
+static const IfaceEntry *iface_lookup(const IfaceTable *table,
+                                      const char *name) {
+  int seed = table->seeds[iface_hash(name, 0) % table->size];
+  int i = (seed < 0) ? -seed - 1 : (int)(iface_hash(name, seed) % table->size);
+  const IfaceEntry *entry = &table->entries[i];
+  return (strcmp(entry->name, name) == 0) ? entry : NULL;
+}
 
-  // If the key is a Scintilla function, return a callable closure.
-  if (is_buffer && !newindex) {
-    lua_getfield(L, LUA_REGISTRYINDEX, "ta_functions");
-    if (lua_pushvalue(L, 2), lua_gettable(L, -2) == LUA_TTABLE)
-      return (lua_pushcclosure(L, lbuf_closure, 1), 1);
-    lua_pop(L, 2); // non-table, ta_functions
+/**
+ * Calls in order the Scintilla functions given in the list of records at stack
+ * index 2 and stores the first result of each call in the table at stack index
+ * 3.
+ * The Scintilla view to call is the light userdata at stack index 1.
+ * Records are of the form `{name, wparam, lparam}`.
+ * @param L The Lua state.
+ * @return 0
+ */
+static int l_callscintillabatch(lua_State *L) {
+  Scintilla *view = (Scintilla *)lua_touserdata(L, 1);
+  for (size_t i = 1; i <= lua_rawlen(L, 2); lua_settop(L, 3), i++) {
+    if (lua_rawgeti(L, 2, i) != LUA_TTABLE)
+      luaL_error(L, "bad batch record #%d (table expected)", (int)i);
+    lua_rawgeti(L, 4, 2), lua_rawgeti(L, 4, 3); // wparam, lparam
+    const IfaceEntry *entry = NULL;
+    if (lua_rawgeti(L, 4, 1) != LUA_TSTRING ||
+        !(entry = iface_lookup(&iface_functions, lua_tostring(L, 7))))
+      luaL_error(L, "bad batch record #%d (unknown function '%s')", (int)i,
+                 luaL_tolstring(L, 7, NULL));
+    // Interface entry is of the form {msg, rtype, wtype, ltype}.
+    const int *f = entry->values;
+    lua_settop(L, 6); // keep wparam and lparam as the last arguments
+    if (l_callscintilla(L, view, f[0], f[2], f[3], f[1], 5) > 0)
+      lua_pushvalue(L, 7), lua_rawseti(L, 3, i);
   }
+  return 0;
+}
 
-  // If the key is a Scintilla property, determine if it is an indexible one or
-  // not. If so, return a table with the appropriate metatable; otherwise call
-  // Scintilla to get or set the property's value.
-  lua_getfield(L, LUA_REGISTRYINDEX, "ta_properties");
-  // If the table is a buffer, the key is given; otherwise the table is an
-  // indexible property.
-  is_buffer ? lua_pushvalue(L, 2) : (void)lua_getfield(L, 1, "property");
-  if (lua_gettable(L, -2) == LUA_TTABLE) {
-    Scintilla *view = focused_view;
-    // Interface table is of the form {get_id, set_id, rtype, wtype}.
-    if (!is_buffer) lua_getfield(L, 1, "buffer");
-    int result = l_globaldoccompare(L, is_buffer ? 1 : -1);
-    if (result != 0) view = (result > 0) ? dummy_view : command_entry;
-    if (!is_buffer) lua_pop(L, 1);
-    if (is_buffer && l_rawgetiint(L, -1, 4) != SVOID) { // indexible property
-      lua_newtable(L);
-      lua_pushvalue(L, 2), lua_setfield(L, -2, "property");
-      lua_pushvalue(L, 1), lua_setfield(L, -2, "buffer");
-      l_setmetatable(L, -1, "ta_bufferp", lbuf_property, lbuf_property);
-      return 1;
-    }
-    int msg = l_rawgetiint(L, -1, !newindex ? 1 : 2);
-    int wtype = l_rawgetiint(L, -1, !newindex ? 4 : 3);
-    int ltype = !newindex ? SVOID : l_rawgetiint(L, -1, 4);
-    int rtype = !newindex ? l_rawgetiint(L, -1, 3) : SVOID;
-    if (newindex &&
-        (ltype != SVOID || wtype == SSTRING || wtype == SSTRINGRET)) {
-      int temp = (wtype != SSTRINGRET) ? wtype : SSTRING;
-      wtype = ltype, ltype = temp;
-    }
-    luaL_argcheck(L, msg != 0, !newindex ? 2 : 3,
-                  !newindex ? "write-only property" : "read-only property");
+/** `buffer.batch()` Lua function. */
+static int lbuffer_batch(lua_State *L) {
+  Scintilla *view = l_globaldocview(L, 1, FALSE);
+  sptr_t doc = send_direct(view, SCI_GETDOCPOINTER, 0, 0);
+  luaL_checktype(L, 2, LUA_TTABLE);
+  int undo = lua_toboolean(L, 3);
+  lua_settop(L, 2);
+  lua_pushcfunction(L, l_callscintillabatch), lua_pushlightuserdata(L, view);
+  lua_pushvalue(L, 2), lua_newtable(L), lua_replace(L, 2); // results
+  lua_pushvalue(L, 2);
+  if (undo) send_direct(view, SCI_BEGINUNDOACTION, 0, 0);
+  BulkScope *scope = bulk_scope(doc);
+  int depth = scope ? scope->depth : 0;
+  int undo_depth = scope ? scope->undo_depth : 0;
+  begin_bulk(doc, FALSE);
+  int ok = (lua_pcall(L, 3, 0, 0) == LUA_OK);
+  // Close any scopes left open by a call that raised an error.
+  while (!ok && (scope = bulk_scope(doc)) && scope->depth > depth + 1) {
+    int leaked_undo = scope->undo_depth > undo_depth;
+    if (leaked_undo) send_direct(view, SCI_ENDUNDOACTION, 0, 0);
+    end_bulk(doc, leaked_undo);
+  }
+  end_bulk(doc, FALSE);
+  if (undo) send_direct(view, SCI_ENDUNDOACTION, 0, 0);
+  lL_emitmodifiedranges(L, doc);
+  return ok ? 1 : lua_error(L);
+}
+
+/** `buffer.begin_bulk()` Lua function. */
+static int lbuffer_begin_bulk(lua_State *L) {
+  Scintilla *view = l_globaldocview(L, 1, TRUE);
+  return (begin_bulk(send_direct(view, SCI_GETDOCPOINTER, 0, 0), FALSE), 0);
+}
+
+/** `buffer.end_bulk()` Lua function. */
+static int lbuffer_end_bulk(lua_State *L) {
+  Scintilla *view = l_globaldocview(L, 1, TRUE);
+  sptr_t doc = send_direct(view, SCI_GETDOCPOINTER, 0, 0);
+  return (end_bulk(doc, FALSE), lL_emitmodifiedranges(L, doc), 0);
+}
+
+// The type of iconv()'s input buffer differs between implementations.
+#if !_WIN32
+#define ICONV_IN char *
+#else
+#define ICONV_IN const char *
+#endif
+
+// Cache of iconv conversion descriptors, most recently used first.
+#define ICONV_CACHE_SIZE 8
+typedef struct {
+  char to[32], from[32];
+  iconv_t cd;
+} IconvCD;
+static IconvCD iconv_cds[ICONV_CACHE_SIZE];
+static int num_iconv_cds;
+
+/**
+ * Returns a conversion descriptor for converting text from encoding `from` to
+ * encoding `to`, or `(iconv_t)-1` if the conversion is not supported.
+ * A cached descriptor is reused if there is one. The caller owns the returned
+ * descriptor until giving it back with iconv_release().
+ * @param to The encoding to convert to.
+ * @param from The encoding to convert from.
+ * @see iconv_release
+ */
+static iconv_t iconv_acquire(const char *to, const char *from) {
+  for (int i = 0; i < num_iconv_cds; i++)
+    if (strcmp(iconv_cds[i].to, to) == 0 &&
+        strcmp(iconv_cds[i].from, from) == 0) {
+      iconv_t cd = iconv_cds[i].cd;
+      memmove(iconv_cds + i, iconv_cds + i + 1,
+              (--num_iconv_cds - i) * sizeof(IconvCD));
+      return cd;
+    }
+  return iconv_open(to, from);
+}
+
+/**
+ * Resets a conversion descriptor returned by iconv_acquire() to its initial
+ * state and puts it in the cache, closing the least recently used descriptor
+ * if the cache is full.
+ * @param to The encoding the descriptor converts to.
+ * @param from The encoding the descriptor converts from.
+ * @param cd The conversion descriptor.
+ */
+static void iconv_release(const char *to, const char *from, iconv_t cd) {
+  if (strlen(to) >= sizeof(iconv_cds[0].to) ||
+      strlen(from) >= sizeof(iconv_cds[0].from)) {
+    iconv_close(cd);
+    return;
+  }
+  iconv(cd, NULL, NULL, NULL, NULL);
+  if (num_iconv_cds == ICONV_CACHE_SIZE)
+    iconv_close(iconv_cds[--num_iconv_cds].cd);
+  memmove(iconv_cds + 1, iconv_cds, num_iconv_cds++ * sizeof(IconvCD));
+  strcpy(iconv_cds[0].to, to), strcpy(iconv_cds[0].from, from);
+  iconv_cds[0].cd = cd;
+}
+
+/**
+ * Converts text with the given conversion descriptor and appends the result to
+ * the given output buffer, doubling the buffer's size as needed.
+ * @param cd The conversion descriptor.
+ * @param inbuf Pointer to the text to convert, which is advanced past the text
+ *   converted. If `NULL`, the sequence (if any) that returns the descriptor to
+ *   its initial shift state is appended instead.
+ * @param inbytesleft Pointer to the length of the text left to convert.
+ * @param outbuf Pointer to the malloc()ed output buffer, which may be
+ *   reallocated.
+ * @param size Pointer to the size of the output buffer.
+ * @param len Pointer to the length of the output buffer's contents.
+ * @return `0` on success, `EINVAL` if the text ends with an incomplete
+ *   multibyte sequence, or `EILSEQ` if the text contains an invalid one
+ */
+static int iconv_append(iconv_t cd, ICONV_IN *inbuf, size_t *inbytesleft,
+                        char **outbuf, size_t *size, size_t *len) {
+  while (TRUE) {
+    char *p = *outbuf + *len;
+    size_t outbytesleft = *size - *len;
+    size_t n = inbuf ? iconv(cd, inbuf, inbytesleft, &p, &outbytesleft) :
+                       iconv(cd, NULL, NULL, &p, &outbytesleft);
+    *len = p - *outbuf;
+    if (n != (size_t)-1) return 0;
+    if (errno != E2BIG) return errno;
+    *outbuf = realloc(*outbuf, *size *= 2);
+  }
+}
+
+#define FILE_CHUNK_SIZE (1 << 20)
+
+/** Summary of a file's contents produced by classify_text(). */
+typedef struct {
+  int binary; // whether or not there is a NUL byte in the first 64 KB
+  int ascii, utf8; // whether or not the text is valid ASCII and UTF-8
+  const char *bom; // the encoding named by the byte order mark, if any
+  size_t lf, crlf; // number of "\n" and "\r\n" line endings
+} TextInfo;
+
+// Word-at-a-time byte tests. HAS_ZERO() is true if any byte in the word is 0,
+// and HAS_BYTE() is true if any byte is c.
+#define ONES 0x0101010101010101ULL
+#define HIGHS 0x8080808080808080ULL
+#define HAS_ZERO(w) (((w) - ONES) & ~(w) & HIGHS)
+#define HAS_BYTE(w, c) HAS_ZERO((w) ^ (ONES * (unsigned char)(c)))
+
+/**
+ * Classifies the given text in a single pass, detecting NUL bytes and a byte
+ * order mark, validating ASCII and UTF-8, and counting line endings.
+ * Runs of ASCII text without NULs or line endings are skipped eight bytes at a
+ * time.
+ * @param s The text to classify.
+ * @param len The length of the text.
+ * @param info The summary to fill in.
+ */
+static void classify_text(const char *s, size_t len, TextInfo *info) {
+  const unsigned char *p = (const unsigned char *)s, *end = p + len;
+  info->binary = FALSE, info->ascii = info->utf8 = TRUE, info->bom = NULL;
+  info->lf = info->crlf = 0;
+  if (len >= 4 && memcmp(p, "\xFF\xFE\0\0", 4) == 0)
+    info->bom = "UTF-32LE";
+  else if (len >= 4 && memcmp(p, "\0\0\xFE\xFF", 4) == 0)
+    info->bom = "UTF-32BE";
+  else if (len >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0)
+    info->bom = "UTF-8";
+  else if (len >= 2 && memcmp(p, "\xFF\xFE", 2) == 0)
+    info->bom = "UTF-16LE";
+  else if (len >= 2 && memcmp(p, "\xFE\xFF", 2) == 0)
+    info->bom = "UTF-16BE";
+  while (p < end) {
+    if (end - p >= 8) {
+      uint64_t w;
+      memcpy(&w, p, 8);
+      if (!(w & HIGHS) && !HAS_ZERO(w) && !HAS_BYTE(w, '\n') &&
+          !HAS_BYTE(w, '\r')) {
+        p += 8;
+        continue;
+      }
+    }
+    unsigned char c = *p++;
+    if (c < 0x80) {
+      if (c == '\n')
+        (p - 2 >= (const unsigned char *)s && p[-2] == '\r') ? info->crlf++ :
+                                                              info->lf++;
+      else if (c == '\0' && p - (const unsigned char *)s <= 65536)
+        info->binary = TRUE;
+      continue;
+    }
+    info->ascii = FALSE;
+    if (!info->utf8) continue;
+    // Validate a multi-byte UTF-8 sequence, rejecting overlong forms,
+    // surrogates, and code points above U+10FFFF.
+    int n = (c >= 0xC2 && c <= 0xDF) ? 1 : (c >= 0xE0 && c <= 0xEF) ? 2 :
+            (c >= 0xF0 && c <= 0xF4) ? 3 : 0;
+    unsigned char lo = (c == 0xE0) ? 0xA0 : (c == 0xF0) ? 0x90 : 0x80,
+                  hi = (c == 0xED) ? 0x9F : (c == 0xF4) ? 0x8F : 0xBF;
+    if (n == 0 || end - p < n || p[0] < lo || p[0] > hi) {
+      info->utf8 = FALSE;
+      continue;
+    }
+    for (int i = 1; i < n; i++)
+      if ((p[i] & 0xC0) != 0x80) info->utf8 = FALSE;
+    if (info->utf8) p += n;
+  }
+}
+
+/**
+ * Returns whether or not the given encoding name refers to the given encoding,
+ * ignoring case and '-' characters.
+ * @param name The encoding name to check.
+ * @param encoding The upper-case encoding name without '-' characters.
+ */
+static int is_encoding(const char *name, const char *encoding) {
+  for (; *name; name++) {
+    if (*name == '-') continue;
+    char c = (*name >= 'a' && *name <= 'z') ? *name - 'a' + 'A' : *name;
+    if (c != *encoding++) return FALSE;
+  }
+  return *encoding == '\0';
+}
+
+/**
+ * Returns whether or not the given text contains a "\r\n" sequence.
+ * @param s The text to search.
+ * @param len The length of the text.
+ * @param cr Whether or not the text preceding this text ended with '\r'.
+ */
+static int has_crlf(const char *s, size_t len, int cr) {
+  if (len > 0 && cr && *s == '\n') return TRUE;
+  for (const char *p = s; (p = memchr(p, '\r', s + len - p)); p++)
+    if (p + 1 < s + len && p[1] == '\n') return TRUE;
+  return FALSE;
+}
+
+/**
+ * Appends the given file data to the end of the Scintilla document in the given
+ * view, converting it from the given encoding to UTF-8 one chunk at a time so
+ * that no converted copy of the whole data is made besides the document's.
+ * If the data cannot be converted, the text appended so far is removed while
+ * any text the document already had is kept.
+ * @param view The Scintilla view.
+ * @param data The file data to append.
+ * @param len The length of the data.
+ * @param from The encoding of the data, or `NULL` to append it unconverted.
+ * @param crlf Pointer to a flag that is set if the converted text contains a
+ *   "\r\n" sequence. It is not touched when appending unconverted data.
+ * @return `TRUE` on success, `FALSE` if the data could not be converted
+ */
+static int append_file_data(Scintilla *view, char *data, size_t len,
+                            const char *from, int *crlf) {
+  if (!from) {
+    for (size_t i = 0; i < len; i += FILE_CHUNK_SIZE) {
+      size_t n = (len - i < FILE_CHUNK_SIZE) ? len - i : FILE_CHUNK_SIZE;
+      send_direct(view, SCI_APPENDTEXT, n, (sptr_t)(data + i));
+    }
+    return TRUE;
+  }
+  *crlf = FALSE;
+  iconv_t cd = iconv_acquire("UTF-8", from);
+  if (cd == (iconv_t)-1) return FALSE;
+  sptr_t start = send_direct(view, SCI_GETLENGTH, 0, 0);
+  ICONV_IN inbuf = data;
+  char *outbuf = malloc(FILE_CHUNK_SIZE);
+  size_t inbytesleft = len;
+  int ok = TRUE, cr = FALSE, flushed = FALSE;
+  while (ok && !flushed) {
+    char *p = outbuf;
+    size_t outbytesleft = FILE_CHUNK_SIZE, n;
+    if (inbytesleft > 0)
+      n = iconv(cd, &inbuf, &inbytesleft, &p, &outbytesleft);
+    else // flush any shift sequence
+      n = iconv(cd, NULL, NULL, &p, &outbytesleft), flushed = TRUE;
+    if (n == (size_t)-1 && errno != E2BIG) {
+      ok = FALSE;
+      break;
+    } else if (n == (size_t)-1) flushed = FALSE;
+    if (p == outbuf) continue;
+    if (!*crlf) *crlf = has_crlf(outbuf, p - outbuf, cr);
+    cr = (p[-1] == '\r');
+    send_direct(view, SCI_APPENDTEXT, p - outbuf, (sptr_t)outbuf);
+  }
+  free(outbuf), iconv_release("UTF-8", from, cd);
+  if (!ok)
+    send_direct(view, SCI_DELETERANGE, start,
+                send_direct(view, SCI_GETLENGTH, 0, 0) - start);
+  return ok;
+}
+
+/** `buffer.load_file()` Lua function. */
+static int lbuffer_load_file(lua_State *L) {
+  Scintilla *view = l_globaldocview(L, 1, FALSE);
+  const char *filename = luaL_checkstring(L, 2);
+  luaL_checktype(L, 3, LUA_TTABLE);
+  FILE *f = fopen(filename, "rb");
+  struct stat st;
+  if (!f || fstat(fileno(f), &st) != 0 || S_ISDIR(st.st_mode)) {
+    if (f) fclose(f), errno = EISDIR;
+    return luaL_error(L, "%s: %s", filename, strerror(errno));
+  }
+  // Read the file in rather than mapping it. Another program truncating a
+  // mapped file while it is being loaded would crash Textadept with SIGBUS.
+  size_t len = st.st_size;
+  char *data = malloc(len + 1);
+  if (!data) errno = ENOMEM; else len = fread(data, 1, len, f);
+  if (!data || ferror(f)) {
+    int err = errno;
+    free(data), fclose(f);
+    return luaL_error(L, "%s: %s", filename, strerror(err));
+  }
+
+  // Classify the data in one pass. Text with a UTF-16 or UTF-32 byte order mark
+  // is converted from that encoding. Otherwise binary data is appended as-is,
+  // and each encoding is tried in turn; UTF-8 and ASCII text is validated by
+  // the classification and never passed through iconv. Undo collection is
+  // disabled while loading since the undo history would keep a second copy of
+  // the text.
+  TextInfo info;
+  classify_text(data, len, &info);
+  int undo = send_direct(view, SCI_GETUNDOCOLLECTION, 0, 0);
+  int crlf = info.crlf > 0, binary = FALSE;
+  const char *encoding = NULL;
+  send_direct(view, SCI_SETUNDOCOLLECTION, 0, 0);
+  send_direct(view, SCI_ALLOCATE, len + 1, 0);
+  sptr_t doc = send_direct(view, SCI_GETDOCPOINTER, 0, 0);
+  begin_bulk(doc, FALSE);
+  if (info.bom && !is_encoding(info.bom, "UTF8")) {
+    lua_pushstring(L, info.bom);
+    if (append_file_data(view, data, len, info.bom, &crlf))
+      encoding = info.bom;
+    else
+      lua_pop(L, 1), crlf = info.crlf > 0; // info.bom
+  }
+  if (!encoding && info.binary)
+    binary = append_file_data(view, data, len, NULL, NULL);
+  else
+    for (size_t i = 1; i <= lua_rawlen(L, 3) && !encoding; i++) {
+      const char *from = (lua_rawgeti(L, 3, i), lua_tostring(L, -1));
+      int utf8 = from && is_encoding(from, "UTF8"),
+          ascii = from && is_encoding(from, "ASCII");
+      if ((utf8 && info.utf8) || (ascii && info.ascii))
+        encoding = from, append_file_data(view, data, len, NULL, NULL);
+      else if (from && !utf8 && !ascii &&
+               append_file_data(view, data, len, from, &crlf))
+        encoding = from;
+      if (!encoding) lua_pop(L, 1), crlf = info.crlf > 0; // encoding
+    }
+  end_bulk(doc, FALSE);
+  send_direct(view, SCI_SETUNDOCOLLECTION, undo, 0);
+  free(data), fclose(f);
+  lL_emitmodifiedranges(L, doc);
+
+  if (binary) lua_pushnil(L); else if (!encoding) lua_pushboolean(L, FALSE);
+  return (lua_pushboolean(L, crlf), 2);
+}
+
+/**
+ * Writes all of the given text to the given file descriptor.
+ * @param fd The file descriptor.
+ * @param s The text to write.
+ * @param len The length of the text.
+ * @return `TRUE` on success, or `FALSE` with errno set
+ */
+static int write_all(int fd, const char *s, size_t len) {
+  while (len > 0) {
+    int n = write(fd, s, len);
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0) return FALSE;
+    s += n, len -= n;
+  }
+  return TRUE;
+}
+
+/**
+ * Returns the malloc()ed path of the file the given symbolic link points to,
+ * following up to 8 links, or a copy of the given path if it is not a link.
+ * @param filename The path to resolve.
+ */
+static char *resolve_links(const char *filename) {
+  char *path = strdup(filename);
+#if !_WIN32
+  struct stat st;
+  for (int i = 0; i < 8 && lstat(path, &st) == 0 && S_ISLNK(st.st_mode); i++) {
+    char target[FILENAME_MAX];
+    int len = readlink(path, target, sizeof(target) - 1);
+    if (len < 0) break;
+    target[len] = '\0';
+    // Relative targets are relative to the link's directory.
+    char *slash = strrchr(path, '/');
+    size_t dirlen = (target[0] != '/' && slash) ? slash - path + 1 : 0;
+    char *next = malloc(dirlen + len + 1);
+    memcpy(next, path, dirlen), strcpy(next + dirlen, target);
+    free(path), path = next;
+  }
+#endif
+  return path;
+}
+
+/**
+ * Writes a save job's text to the given file descriptor, converting it one
+ * chunk at a time, and then flushes the file to disk.
+ * This may run in a separate thread, so it must not use Lua or Scintilla.
+ * @param job The save job.
+ * @param fd The file descriptor, or -1 to only check that the text converts.
+ * @return 0 on success, `EILSEQ` if the text could not be converted, or errno
+ */
+static int write_save_text(SaveJob *job, int fd) {
+  const char *p = job->text, *end = p + job->len;
+  size_t size = FILE_CHUNK_SIZE, len = 0;
+  char *outbuf = job->encoding ? malloc(size) : NULL;
+  int error = 0;
+  if (outbuf) iconv(job->cd, NULL, NULL, NULL, NULL); // reset
+  while (!error && p < end) {
+    size_t n = (end - p < FILE_CHUNK_SIZE) ? end - p : FILE_CHUNK_SIZE;
+    if (!outbuf) {
+      if (fd >= 0 && !write_all(fd, p, n)) error = errno;
+      p += n;
+      continue;
+    }
+    // A multibyte sequence cut off by the end of a chunk starts the next one.
+    ICONV_IN inbuf = (ICONV_IN)p;
+    len = 0;
+    int err = iconv_append(job->cd, &inbuf, &n, &outbuf, &size, &len);
+    p = inbuf;
+    if (err == EILSEQ || (err == EINVAL && p + n == end))
+      error = EILSEQ;
+    else if (fd >= 0 && !write_all(fd, outbuf, len))
+      error = errno;
+  }
+  if (outbuf && !error) {
+    len = 0, iconv_append(job->cd, NULL, NULL, &outbuf, &size, &len);
+    if (fd >= 0 && !write_all(fd, outbuf, len)) error = errno;
+  }
+  free(outbuf);
+  if (fd < 0) return error;
+#if !_WIN32
+  if (!error && fsync(fd) != 0) error = errno;
+#else
+  if (!error && _commit(fd) != 0) error = errno;
+#endif
+  return error;
+}
+
+/**
+ * Writes a save job's text over the file to save.
+ * The text is checked to convert before the file is truncated, but the file is
+ * left partially written if writing fails.
+ * This may run in a separate thread, so it must not use Lua or Scintilla.
+ * @param job The save job.
+ */
+static void write_save_job_in_place(SaveJob *job) {
+  if (job->encoding && (job->error = write_save_text(job, -1))) return;
+  int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#if _WIN32
+  flags |= O_BINARY;
+#endif
+  int fd = open(job->filename, flags, 0666);
+  if (fd < 0) {
+    job->error = errno;
+    return;
+  }
+  job->error = write_save_text(job, fd);
+  if (close(fd) != 0 && !job->error) job->error = errno;
+}
+
+/**
+ * Writes a save job's text to the job's temporary file, then renames that file
+ * over the file to save, so that the latter is never left partially written.
+ * The file's permissions, and its owner and group where permitted, are kept.
+ * Files with hard links, and files whose temporary file cannot be created or
+ * renamed, are written in place instead.
+ * This may run in a separate thread, so it must not use Lua or Scintilla.
+ * On failure, the job's error is set to errno, or to `EILSEQ` if the text could
+ * not be converted, and the temporary file is removed.
+ * @param job The save job.
+ */
+static void write_save_job(SaveJob *job) {
+  if (job->in_place) {
+    write_save_job_in_place(job);
+    return;
+  }
+  int flags = O_WRONLY | O_CREAT | O_EXCL;
+#if _WIN32
+  flags |= O_BINARY;
+#endif
+  int fd = open(job->tmpname, flags, 0666);
+  if (fd < 0) {
+    write_save_job_in_place(job); // e.g. the directory is not writable
+    return;
+  }
+  job->error = write_save_text(job, fd);
+#if !_WIN32
+  // Keep the file's owner and group, or at least its group. Failing to is not
+  // an error, but set-ID bits are then dropped.
+  int mode = job->mode;
+  if (!job->error && mode >= 0 && fchown(fd, job->uid, job->gid) != 0)
+    mode &= (fchown(fd, (uid_t)-1, job->gid) == 0) ? ~04000 : ~06000;
+  if (!job->error && mode >= 0 && fchmod(fd, mode) != 0) job->error = errno;
+#endif
+  if (close(fd) != 0 && !job->error) job->error = errno;
+  if (job->error) {
+    remove(job->tmpname);
+    return;
+  }
+#if !_WIN32
+  if (rename(job->tmpname, job->filename) != 0) {
+    remove(job->tmpname), write_save_job_in_place(job);
+    return;
+  }
+  char *slash = strrchr(job->tmpname, '/');
+  if (slash) {
+    // Flush the rename to disk too.
+    *(slash > job->tmpname ? slash : slash + 1) = '\0';
+    if ((fd = open(job->tmpname, O_RDONLY)) >= 0) fsync(fd), close(fd);
+  }
+#else
+  if (!MoveFileEx(job->tmpname, job->filename,
+                  MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    remove(job->tmpname), write_save_job_in_place(job);
+#endif
+}
+
+/**
+ * Waits for a save job to finish, frees it, and then calls its Lua function
+ * with `true` on success, `false` if the text could not be converted, or `nil`
+ * and an error message.
+ * @param L The Lua state.
+ * @param job The save job.
+ * @param call Whether or not to call the job's Lua function.
+ */
+static void finish_save(lua_State *L, SaveJob *job, int call) {
+  if (job->threaded) {
+#if GTK
+    g_thread_join(job->thread), g_idle_remove_by_data(job);
+#elif !_WIN32
+    pthread_join(job->thread, NULL);
+#endif
+    for (SaveJob **p = &save_jobs; *p; p = &(*p)->next)
+      if (*p == job) {
+        *p = job->next;
+        break;
+      }
+  }
+  if (job->encoding) iconv_release(job->encoding, "UTF-8", job->cd);
+  SS(focused_view, SCI_RELEASEDOCUMENT, 0, job->doc);
+  lua_rawgeti(L, LUA_REGISTRYINDEX, job->ref);
+  luaL_unref(L, LUA_REGISTRYINDEX, job->ref);
+  int nargs = 1;
+  if (!job->error || job->error == EILSEQ)
+    lua_pushboolean(L, !job->error);
+  else
+    lua_pushnil(L), lua_pushfstring(L, "%s: %s", job->filename,
+                                    strerror(job->error)), nargs++;
+  free(job->encoding), free(job->filename), free(job->tmpname), free(job);
+  if (!call)
+    lua_pop(L, 1 + nargs); // function and arguments
+  else if (lua_pcall(L, nargs, 0, 0) != LUA_OK)
+    lL_event(L, "error", LUA_TSTRING, lua_tostring(L, -1), -1), lua_pop(L, 1);
+}
+
+/**
+ * Finishes all save jobs, waiting for their threads.
+ * @param L The Lua state.
+ * @param call Whether or not to call the jobs' Lua functions.
+ */
+static void finish_saves(lua_State *L, int call) {
+  while (save_jobs) finish_save(L, save_jobs, call);
+#if (CURSES && !_WIN32)
+  SaveJob *job;
+  if (save_pipe[0] >= 0)
+    while (read(save_pipe[0], &job, sizeof(job)) > 0) ; // discard
+#endif
+}
+
+#if GTK
+/** Finishes a save job in the main loop after its thread is done. */
+static int save_done(void *job) { return (finish_save(lua, job, TRUE), FALSE); }
+#endif
+
+#if (GTK || !_WIN32)
+/**
+ * Runs a save job in a separate thread and then has the main loop finish it.
+ * @param job The save job.
+ */
+static void *save_thread(void *job) {
+  write_save_job(job);
+#if GTK
+  g_idle_add(save_done, job);
+#else
+  while (write(save_pipe[1], &job, sizeof(job)) < 0 && errno == EINTR) ;
+#endif
+  return NULL;
+}
+#endif
+
+/** `buffer.save_file()` Lua function. */
+static int lbuffer_save_file(lua_State *L) {
+  Scintilla *view = l_globaldocview(L, 1, TRUE);
+  const char *filename = luaL_checkstring(L, 2);
+  const char *encoding = luaL_optstring(L, 3, NULL);
+  luaL_checktype(L, 4, LUA_TFUNCTION);
+  luaL_argcheck(L, send_direct(view, SCI_GETREADONLY, 0, 0), 1,
+                "read-only Buffer expected");
+  SaveJob *job = calloc(1, sizeof(SaveJob));
+  if (encoding && !is_encoding(encoding, "UTF8")) {
+    if ((job->cd = iconv_acquire(encoding, "UTF-8")) == (iconv_t)-1)
+      return (free(job), luaL_error(L, "invalid encoding"));
+    job->encoding = strdup(encoding);
+  }
+  // Write through symbolic links, keep the file's permissions, and write to a
+  // temporary file in the same directory so it can be renamed over the file.
+  job->filename = resolve_links(filename);
+#if !_WIN32
+  long pid = getpid();
+#else
+  long pid = GetCurrentProcessId();
+#endif
+  struct stat st;
+  job->mode = (stat(job->filename, &st) == 0) ? (int)(st.st_mode & 07777) : -1;
+#if !_WIN32
+  job->uid = st.st_uid, job->gid = st.st_gid;
+#endif
+  // Renaming a file over one with hard links would split them.
+  job->in_place = job->mode >= 0 && st.st_nlink > 1;
+  job->tmpname = malloc(strlen(job->filename) + 48);
+  sprintf(job->tmpname, "%s.%ld-%u.tmp", job->filename, pid, num_saves++);
+  // The read-only document's text does not move until it is modified, and the
+  // reference keeps it from being freed if its buffer is deleted first.
+  job->doc = send_direct(view, SCI_GETDOCPOINTER, 0, 0);
+  send_direct(view, SCI_ADDREFDOCUMENT, 0, job->doc);
+  job->text = (const char *)send_direct(view, SCI_GETCHARACTERPOINTER, 0, 0);
+  job->len = send_direct(view, SCI_GETLENGTH, 0, 0);
+  lua_pushvalue(L, 4), job->ref = luaL_ref(L, LUA_REGISTRYINDEX);
+
+  // Small files are saved right away since starting a thread is not worth it.
+  // The terminal version's main loop learns of finished jobs through a pipe.
+  if (job->len >= FILE_CHUNK_SIZE) {
+#if GTK
+    job->threaded = TRUE, job->thread = g_thread_new("save", save_thread, job);
+#elif !_WIN32
+    if (save_pipe[0] < 0 && pipe(save_pipe) == 0)
+      fcntl(save_pipe[0], F_SETFL, O_NONBLOCK);
+    job->threaded = save_pipe[0] >= 0 &&
+                    pthread_create(&job->thread, NULL, save_thread, job) == 0;
+#endif
+  }
+  if (job->threaded) return (job->next = save_jobs, save_jobs = job, 0);
+  return (write_save_job(job), finish_save(L, job, TRUE), 0);
+}
+
+// Maximum number of line insertions and deletions diff_lines() looks for.
+#define MAX_DIFF_EDITS 1000
+
+/** A line of text for diff_lines(). */
+typedef struct {
+  const char *s; // the line's text, including its line ending
+  size_t len; // the length of that text
+  unsigned int hash; // hash of that text
+} DiffLine;
+
+/** A range of lines in one text replaced by a range of lines in another. */
+typedef struct {
+  int a_start, a_end; // the range of lines in the first text
+  int b_start, b_end; // the range of lines in the second text
+} DiffHunk;
+
+/**
+ * Splits the given text into lines, hashing each one.
+ * @param s The text to split.
+ * @param len The length of the text.
+ * @param n Pointer to the number of lines, which is set.
+ * @return malloc()ed array of lines
+ */
+static DiffLine *split_lines(const char *s, size_t len, int *n) {
+  int size = 64;
+  DiffLine *lines = malloc(size * sizeof(DiffLine));
+  const char *end = s + len;
+  for (*n = 0; s < end; (*n)++) {
+    const char *eol = memchr(s, '\n', end - s);
+    size_t line_len = (eol ? eol + 1 : end) - s;
+    unsigned int hash = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < line_len; i++)
+      hash = (hash ^ (unsigned char)s[i]) * 16777619u;
+    if (*n == size) lines = realloc(lines, (size *= 2) * sizeof(DiffLine));
+    lines[*n].s = s, lines[*n].len = line_len, lines[*n].hash = hash;
+    s += line_len;
+  }
+  return lines;
+}
+
+/** Returns whether or not the given lines are equal. */
+static int lines_equal(DiffLine *a, DiffLine *b) {
+  return a->hash == b->hash && a->len == b->len &&
+         memcmp(a->s, b->s, a->len) == 0;
+}
+
+/**
+ * Computes the smallest set of hunks that turn lines `a` into lines `b` using
+ * Myers' O(ND) difference algorithm.
+ * @param a The first list of lines.
+ * @param n The number of lines in `a`.
+ * @param b The second list of lines.
+ * @param m The number of lines in `b`.
+ * @param num_hunks Pointer to the number of hunks, which is set.
+ * @return malloc()ed array of hunks in reverse order, or `NULL` if there are
+ *   more than `MAX_DIFF_EDITS` line insertions and deletions
+ */
+static DiffHunk *diff_lines(DiffLine *a, int n, DiffLine *b, int m,
+                            int *num_hunks) {
+  // v[k] is the furthest x reached on diagonal k = x - y. The furthest points
+  // for each number of edits d are kept in trace, starting at index d * d, for
+  // walking back through the edits afterwards.
+  int off = MAX_DIFF_EDITS + 1, *v = malloc((2 * off + 1) * sizeof(int));
+  int *trace = NULL, size = 0, d;
+  v[off + 1] = 0;
+  for (d = 0; d <= MAX_DIFF_EDITS; d++) {
+    int done = FALSE;
+    for (int k = -d; k <= d && !done; k += 2) {
+      int x = (k == -d || (k != d && v[off + k - 1] < v[off + k + 1])) ?
+              v[off + k + 1] : v[off + k - 1] + 1, y = x - k;
+      while (x < n && y < m && lines_equal(&a[x], &b[y])) x++, y++;
+      v[off + k] = x, done = (x >= n && y >= m);
+    }
+    if ((d + 1) * (d + 1) > size)
+      trace = realloc(trace, (size = 4 * (d + 1) * (d + 1)) * sizeof(int));
+    memcpy(trace + d * d, v + off - d, (2 * d + 1) * sizeof(int));
+    if (done) break;
+  }
+  free(v);
+  if (d > MAX_DIFF_EDITS) return (free(trace), NULL);
+
+  // Walk back through the edits, merging adjacent ones into hunks.
+  DiffHunk *hunks = malloc((d + 1) * sizeof(DiffHunk));
+  int x = n, y = m;
+  *num_hunks = 0;
+  for (; d > 0; d--) {
+    int *prev = trace + (d - 1) * (d - 1) + (d - 1); // prev[0] is for k = 0
+    int k = x - y, down = (k == -d || (k != d && prev[k - 1] < prev[k + 1]));
+    int prev_k = down ? k + 1 : k - 1, prev_x = prev[prev_k];
+    int prev_y = prev_x - prev_k;
+    // The edit is either a line inserted from b or a line deleted from a.
+    int a_start = prev_x, b_start = prev_y;
+    int a_end = down ? prev_x : prev_x + 1, b_end = down ? prev_y + 1 : prev_y;
+    DiffHunk *hunk = (*num_hunks > 0) ? &hunks[*num_hunks - 1] : NULL;
+    if (hunk && hunk->a_start == a_end && hunk->b_start == b_end)
+      hunk->a_start = a_start, hunk->b_start = b_start;
+    else
+      hunks[(*num_hunks)++] = (DiffHunk){a_start, a_end, b_start, b_end};
+    x = prev_x, y = prev_y;
+  }
+  return (free(trace), hunks);
+}
+
+/** `buffer.update_text()` Lua function. */
+static int lbuffer_update_text(lua_State *L) {
+  Scintilla *view = l_globaldocview(L, 1, FALSE);
+  luaL_argcheck(L, !send_direct(view, SCI_GETREADONLY, 0, 0), 1,
+                "writable Buffer expected");
+  size_t b_len, a_len = send_direct(view, SCI_GETLENGTH, 0, 0);
+  const char *b = luaL_checklstring(L, 2, &b_len);
+  const char *a = (const char *)send_direct(view, SCI_GETCHARACTERPOINTER, 0,
+                                            0);
+  // Skip the lines both texts start and end with.
+  size_t start = 0, end = 0;
+  while (start < a_len && start < b_len && a[start] == b[start]) start++;
+  while (start > 0 && a[start - 1] != '\n') start--;
+  while (end < a_len - start && end < b_len - start &&
+         a[a_len - end - 1] == b[b_len - end - 1]) end++;
+  while (end > 0 && a_len - end > start && b_len - end > start &&
+         (a[a_len - end - 1] != '\n' || b[b_len - end - 1] != '\n')) end--;
+  if (start == a_len && start == b_len) return 0; // no changes
+
+  // Diff the lines in between, falling back on replacing all of them if there
+  // are too many changes.
+  int n, m, num_hunks = 1;
+  DiffLine *a_lines = split_lines(a + start, a_len - end - start, &n);
+  DiffLine *b_lines = split_lines(b + start, b_len - end - start, &m);
+  DiffHunk *hunks = diff_lines(a_lines, n, b_lines, m, &num_hunks);
+  if (!hunks)
+    hunks = malloc(sizeof(DiffHunk)), *hunks = (DiffHunk){0, n, 0, m};
+
+  // Convert line numbers to positions, since the document's text may move once
+  // it is modified.
+  size_t (*ranges)[4] = malloc(num_hunks * sizeof(*ranges));
+  const char *a_stop = a + a_len - end, *b_stop = b + b_len - end;
+  for (int i = 0; i < num_hunks; i++) {
+    DiffHunk *h = &hunks[i];
+    ranges[i][0] = ((h->a_start < n) ? a_lines[h->a_start].s : a_stop) - a;
+    ranges[i][1] = ((h->a_end < n) ? a_lines[h->a_end].s : a_stop) - a;
+    ranges[i][2] = ((h->b_start < m) ? b_lines[h->b_start].s : b_stop) - b;
+    ranges[i][3] = ((h->b_end < m) ? b_lines[h->b_end].s : b_stop) - b;
+  }
+  free(a_lines), free(b_lines), free(hunks);
+
+  // Replace changed lines from the last to the first so that the positions of
+  // the ones not replaced yet stay the same.
+  sptr_t doc = send_direct(view, SCI_GETDOCPOINTER, 0, 0);
+  send_direct(view, SCI_BEGINUNDOACTION, 0, 0);
+  begin_bulk(doc, FALSE);
+  for (int i = 0; i < num_hunks; i++) {
+    send_direct(view, SCI_SETTARGETRANGE, ranges[i][0], ranges[i][1]);
+    send_direct(view, SCI_REPLACETARGET, ranges[i][3] - ranges[i][2],
+                (sptr_t)(b + ranges[i][2]));
+  }
+  end_bulk(doc, FALSE);
+  send_direct(view, SCI_ENDUNDOACTION, 0, 0);
+  free(ranges);
+  return (lL_emitmodifiedranges(L, doc), 0);
+}
+
+/**
+ * Returns whether or not the Scintilla function with the given name only
+ * queries a document, so that it may be called through any view showing it.
+ * @param name The function's name.
+ */
+static int is_query_function(const char *name) {
+  static const char *queries[] = {
+    "brace_match", "count_characters", "find_column", "line_from_position",
+    "line_length", "position_after", "position_before", "position_from_line",
+    "position_relative", "word_end_position", "word_start_position"
+  };
+  if (strncmp(name, "get_", 4) == 0) return TRUE;
+  for (size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); i++)
+    if (strcmp(name, queries[i]) == 0) return TRUE;
+  return FALSE;
+}
+
+/**
+ * Calls the Scintilla function whose interface entry is the closure's first
+ * upvalue. The entry is resolved once by l_pushbufkey, as is the second
+ * upvalue, which is whether or not the function only queries the document.
+ */
+static int lbuf_closure(lua_State *L) {
+  Scintilla *view = focused_view;
+  // If optional buffer/view argument is given, check it.
+  if (lua_istable(L, 1)) {
+    //if (lL_hasmetatable(L, 1, "ta_view"))
+    //  lua_getfield(L, 1, "buffer"), lua_replace(L, 1); // use view.buffer
+    view = l_globaldocview(L, 1, lua_toboolean(L, lua_upvalueindex(2)));
+  }
+  // Interface entry is of the form {msg, rtype, wtype, ltype}.
+  IfaceEntry *entry = (IfaceEntry *)lua_touserdata(L, lua_upvalueindex(1));
+  const int *f = entry->values;
+  return l_callscintilla(L, view, f[0], f[2], f[3], f[1],
+                         lua_istable(L, 1) ? 2 : 1);
+}
+
+/**
+ * Resolves the buffer key at stack index 2 into a Scintilla function closure,
+ * property interface entry (as light userdata), or constant, pushes it, and
+ * caches it in the 'ta_bufcache' table (the first upvalue of the current
+ * function) so that subsequent lookups of that key are a single raw table
+ * access.
+ * Pushes `false` for keys that are none of these.
+ * @param L The Lua state.
+ */
+static void l_pushbufkey(lua_State *L) {
+  const char *key = (lua_type(L, 2) == LUA_TSTRING) ? lua_tostring(L, 2) : "";
+  const IfaceEntry *entry;
+  // `buffer:text_range()` is SCI_GETTEXTRANGE, which l_callscintilla() handles
+  // with positions rather than Scintilla's struct.
+  if (strcmp(key, "text_range") == 0) key = "get_text_range";
+  if ((entry = iface_lookup(&iface_functions, key))) {
+    lua_pushlightuserdata(L, (void *)entry);
+    lua_pushboolean(L, is_query_function(entry->name));
+    lua_pushcclosure(L, lbuf_closure, 2);
+  } else if ((entry = iface_lookup(&iface_properties, key)))
+    lua_pushlightuserdata(L, (void *)entry);
+  else if ((entry = iface_lookup(&iface_constants, key)))
+    lua_pushinteger(L, entry->values[0]);
+  else
+    lua_pushboolean(L, FALSE);
+  lua_pushvalue(L, 2), lua_pushvalue(L, -2);
+  lua_rawset(L, lua_upvalueindex(1));
+}
+
+/** `buffer.__index` and `buffer.__newindex` Lua metamethods. */
+static int lbuf_property(lua_State *L) {
+  int newindex = (lua_gettop(L) == 3);
+  // Only ta_buffer metamethods have upvalues; ta_bufferp metamethods do not.
+  int is_buffer = lua_istable(L, lua_upvalueindex(1));
+
+  // If the table is a buffer, fetch the key's resolved Scintilla function,
+  // property, or constant from the cache; otherwise the table is an indexible
+  // property, so fetch its interface entry.
+  if (is_buffer) {
+    lua_pushvalue(L, 2);
+    if (lua_rawget(L, lua_upvalueindex(1)) == LUA_TNIL)
+      lua_pop(L, 1), l_pushbufkey(L); // nil
+  } else {
+    lua_getfield(L, 1, "property");
+    const char *name = lua_tostring(L, -1);
+    lua_pop(L, 1); // property
+    lua_pushlightuserdata(L, (void *)iface_lookup(&iface_properties, name));
+  }
+
+  // If the key is a Scintilla function, return its callable closure.
+  if (lua_isfunction(L, -1) && !newindex) return 1;
+
+  // If the key is a Scintilla property, determine if it is an indexible one or
+  // not. If so, return a table with the appropriate metatable; otherwise call
+  // Scintilla to get or set the property's value.
+  if (lua_islightuserdata(L, -1)) {
+    // Interface entry is of the form {get_id, set_id, rtype, wtype}.
+    const int *p = ((IfaceEntry *)lua_touserdata(L, -1))->values;
+    if (!is_buffer) lua_getfield(L, 1, "buffer");
+    Scintilla *view = l_globaldocview(L, is_buffer ? 1 : -1, !newindex);
+    if (!is_buffer) lua_pop(L, 1);
+    if (is_buffer && p[3] != SVOID) { // indexible property
+      // Reuse the buffer's table for this property if one was created before.
+      lua_pushvalue(L, 1);
+      if (lua_rawget(L, lua_upvalueindex(2)) != LUA_TTABLE) {
+        lua_pop(L, 1), lua_newtable(L); // non-table
+        lua_pushvalue(L, 1), lua_pushvalue(L, -2);
+        lua_rawset(L, lua_upvalueindex(2));
+      }
+      if (lua_pushvalue(L, 2), lua_rawget(L, -2) == LUA_TTABLE) return 1;
+      lua_pop(L, 1); // non-table
+      lua_newtable(L);
+      lua_pushvalue(L, 2), lua_setfield(L, -2, "property");
+      lua_pushvalue(L, 1), lua_setfield(L, -2, "buffer");
+      l_setmetatable(L, -1, "ta_bufferp", lbuf_property, lbuf_property);
+      lua_pushvalue(L, 2), lua_pushvalue(L, -2), lua_rawset(L, -4);
+      return 1;
+    }
+    int msg = p[!newindex ? 0 : 1], wtype = p[!newindex ? 3 : 2];
+    int ltype = !newindex ? SVOID : p[3], rtype = !newindex ? p[2] : SVOID;
+    if (newindex &&
+        (ltype != SVOID || wtype == SSTRING || wtype == SSTRINGRET)) {
+      int temp = (wtype != SSTRINGRET) ? wtype : SSTRING;
+      wtype = ltype, ltype = temp;
+    }
+    luaL_argcheck(L, msg != 0, !newindex ? 2 : 3,
+                  !newindex ? "write-only property" : "read-only property");
     return l_callscintilla(L, view, msg, wtype, ltype, rtype,
                            (!is_buffer || !newindex) ? 2 : 3);
-  } else lua_pop(L, 2); // non-table, ta_properties
+  }
+
+  // If the key is a Scintilla constant, return its value.
+  if (lua_type(L, -1) == LUA_TNUMBER && !newindex) return 1;
+  lua_pop(L, 1); // non-function, non-property, non-constant
 
   if (strcmp(lua_tostring(L, 2), "tab_label") == 0 &&
       l_todoc(L, 1) != SS(command_entry, SCI_GETDOCPOINTER, 0, 0)) {
@@ -1312,16 +3004,33 @@ static int lbuf_property(lua_State *L) {
     if (newindex) wresize(win, height, COLS), mvwin(win, LINES - 1 - height, 0);
 #endif
     return !newindex ? 1 : 0;
-  } else if (!newindex) {
-    // If the key is a Scintilla constant, return its value.
-    lua_getfield(L, LUA_REGISTRYINDEX, "ta_constants");
-    if (lua_pushvalue(L, 2), lua_gettable(L, -2) == LUA_TNUMBER) return 1;
-    lua_pop(L, 2); // non-number, ta_constants
   }
 
   return !newindex ? (lua_rawget(L, 1), 1) : (lua_rawset(L, 1), 0);
 }
 
+/**
+ * Sets the metatable of the buffer at the given index, creating it if
+ * necessary.
+ * Its metamethods share two upvalues: the 'ta_bufcache' table of resolved
+ * buffer keys (see l_pushbufkey) and the 'ta_bufferps' table of each buffer's
+ * indexible property tables.
+ * @param L The Lua state.
+ * @param index The stack index of the buffer.
+ */
+static void lL_setbuffermetatable(lua_State *L, int index) {
+  if (luaL_newmetatable(L, "ta_buffer")) {
+    lua_newtable(L), lua_pushvalue(L, -1);
+    lua_setfield(L, LUA_REGISTRYINDEX, "ta_bufcache");
+    lua_newtable(L), lua_pushvalue(L, -1);
+    lua_setfield(L, LUA_REGISTRYINDEX, "ta_bufferps");
+    lua_pushvalue(L, -2), lua_pushvalue(L, -2);
+    lua_pushcclosure(L, lbuf_property, 2), lua_setfield(L, -5, "__index");
+    lua_pushcclosure(L, lbuf_property, 2), lua_setfield(L, -2, "__newindex");
+  }
+  lua_setmetatable(L, (index > 0) ? index : index - 1);
+}
+
 /**
  * Adds a Scintilla document with a metatable to the 'buffers' registry table.
  * @param L The Lua state.
@@ -1340,7 +3049,14 @@ static void lL_adddoc(lua_State *L, sptr_t doc) {
 #endif
   l_setcfunction(L, -2, "delete", lbuffer_delete);
   l_setcfunction(L, -2, "new", lbuffer_new);
-  l_setmetatable(L, -2, "ta_buffer", lbuf_property, lbuf_property);
+  l_setcfunction(L, -2, "slice", lbuffer_slice);
+  l_setcfunction(L, -2, "batch", lbuffer_batch);
+  l_setcfunction(L, -2, "begin_bulk", lbuffer_begin_bulk);
+  l_setcfunction(L, -2, "end_bulk", lbuffer_end_bulk);
+  l_setcfunction(L, -2, "load_file", lbuffer_load_file);
+  l_setcfunction(L, -2, "save_file", lbuffer_save_file);
+  l_setcfunction(L, -2, "update_text", lbuffer_update_text);
+  lL_setbuffermetatable(L, -2);
   // t[doc_pointer] = buffer, t[#t + 1] = buffer, t[buffer] = #t
   lua_pushvalue(L, -2), lua_settable(L, -4);
   lua_pushvalue(L, -1), lua_rawseti(L, -3, lua_rawlen(L, -3) + 1);
@@ -1349,112 +3065,868 @@ static void lL_adddoc(lua_State *L, sptr_t doc) {
 }
 
 /**
- * Creates a new Scintilla document and adds it to the Lua state.
- * Generates 'buffer_before_switch' and 'buffer_new' events.
- * @param doc Almost always zero, except for the first Scintilla view created,
- *   in which its doc pointer would be given here since it already has a
- *   pre-created buffer.
- * @see lL_adddoc
+ * Creates a new Scintilla document and adds it to the Lua state.
+ * Generates 'buffer_before_switch' and 'buffer_new' events.
+ * @param doc Almost always zero, except for the first Scintilla view created,
+ *   in which its doc pointer would be given here since it already has a
+ *   pre-created buffer.
+ * @see lL_adddoc
+ */
+static void new_buffer(sptr_t doc) {
+  trace_begin("buffer", "new_buffer", 0);
+  if (!doc) {
+    doc = SS(focused_view, SCI_CREATEDOCUMENT, 0, 0); // create the new document
+    lL_event(lua, "buffer_before_switch", -1);
+    lL_adddoc(lua, doc);
+    lL_gotodoc(lua, focused_view, -1, FALSE);
+  } else lL_adddoc(lua, doc), SS(focused_view, SCI_ADDREFDOCUMENT, 0, doc);
+#if GTK
+  // Add a tab to the tabbar.
+  l_pushdoc(lua, SS(focused_view, SCI_GETDOCPOINTER, 0, 0));
+  lua_getfield(lua, -1, "tab_pointer");
+  GtkWidget *tab = (GtkWidget *)lua_touserdata(lua, -1);
+  tab_sync = TRUE;
+  int i = gtk_notebook_append_page(GTK_NOTEBOOK(tabbar), tab, NULL);
+  gtk_widget_show(tab), gtk_widget_set_visible(tabbar, show_tabs && i > 0);
+  gtk_notebook_set_current_page(GTK_NOTEBOOK(tabbar), i);
+  tab_sync = FALSE;
+  lua_pop(lua, 2); // tab_pointer and buffer
+//#elif CURSES
+  // TODO: tabs
+#endif
+  l_setglobaldoc(lua, doc);
+  if (!initing) lL_event(lua, "buffer_new", -1);
+  trace_finish();
+}
+
+/** `_G.quit()` Lua function. */
+static int lquit(lua_State *L) {
+#if GTK
+  GdkEventAny event = {GDK_DELETE, gtk_widget_get_window(window), TRUE};
+  gdk_event_put((GdkEvent *)&event);
+#elif CURSES
+  quit = TRUE;
+#endif
+  return 0;
+}
+
+#if _WIN32
+char *stpcpy(char *dest, const char *src) {
+  return (strcpy(dest, src), dest + strlen(src));
+}
+#endif
+
+/** lua_Writer for writing to a file. */
+static int l_fwrite(lua_State *L, const void *p, size_t size, void *f) {
+  return fwrite(p, 1, size, (FILE *)f) != size;
+}
+
+/**
+ * Loads the given Lua file as a Lua chunk like luaL_loadfile() does, but
+ * through a bytecode cache in `_USERHOME/cache/`.
+ * Cache files are named after a hash of the file's path and the Lua version
+ * (501 is LuaJIT), and start with the file's modification time, size, inode
+ * and status change time. The last two catch files replaced by a copy that
+ * keeps the original's modification time and size. If these do not match, the
+ * file is compiled from source and its cache file rewritten. Files loaded
+ * before `_USERHOME` is defined are not cached.
+ * @param L The Lua state.
+ * @param filename The file to load.
+ * @return LUA_OK or a luaL_loadfile() error code
+ */
+static int lL_loadfile(lua_State *L, const char *filename) {
+  int top = lua_gettop(L), status;
+  struct stat st;
+  if (lua_getglobal(L, "_USERHOME") != LUA_TSTRING || stat(filename, &st) != 0)
+    return (lua_settop(L, top), luaL_loadfile(L, filename));
+  unsigned long long hash = 14695981039346656037ULL; // FNV-1a
+  for (const char *p = filename; *p; p++)
+    hash = (hash ^ (unsigned char)*p) * 1099511628211ULL;
+  char key[32], header[96];
+  snprintf(key, sizeof(key), "%016llx.luac%d", hash, LUA_VERSION_NUM);
+  int header_len = snprintf(header, sizeof(header), "%lld %lld %llu %lld\n",
+                            (long long)st.st_mtime, (long long)st.st_size,
+                            (unsigned long long)st.st_ino,
+                            (long long)st.st_ctime);
+  const char *cache = lua_pushfstring(L, "%s/cache/%s", lua_tostring(L, -1),
+                                      key);
+  FILE *f = fopen(cache, "rb");
+  if (f) {
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    char *bytecode = malloc(len > 0 ? len : 1);
+    rewind(f);
+    int ok = len > header_len && fread(bytecode, 1, len, f) == (size_t)len &&
+             memcmp(bytecode, header, header_len) == 0;
+    fclose(f);
+    if (ok) {
+      lua_pushfstring(L, "@%s", filename);
+      status = luaL_loadbuffer(L, bytecode + header_len, len - header_len,
+                               lua_tostring(L, -1));
+      ok = (status == LUA_OK);
+      if (!ok) lua_pop(L, 2); // error, chunk name; recompile
+    }
+    free(bytecode);
+    if (ok) return (lua_replace(L, top + 1), lua_settop(L, top + 1), LUA_OK);
+  }
+  if ((status = luaL_loadfile(L, filename)) == LUA_OK) {
+    const char *tmp = lua_pushfstring(L, "%s.tmp", cache);
+    if ((f = fopen(tmp, "wb"))) {
+      fputs(header, f);
+      lua_pushvalue(L, -2); // chunk
+      int ok = (lua_dump(L, l_fwrite, f, 0) == 0);
+      lua_pop(L, 1); // chunk
+      if (fclose(f) == 0 && ok) {
+#if _WIN32
+        remove(cache);
+#endif
+        rename(tmp, cache);
+      } else remove(tmp);
+    }
+    lua_pop(L, 1); // temporary file name
+  }
+  return (lua_replace(L, top + 1), lua_settop(L, top + 1), status);
+}
+
+/**
+ * Lua package searcher that loads Lua modules through the bytecode cache.
+ * Takes the place of Lua's own searcher for Lua modules in `package.path`.
+ * @see lL_loadfile
+ */
+static int lsearcher(lua_State *L) {
+  const char *name = luaL_checkstring(L, 1);
+  lua_getglobal(L, "package"), lua_getfield(L, -1, "searchpath");
+  lua_pushvalue(L, 1), lua_getfield(L, -3, "path"), lua_call(L, 2, 2);
+  if (lua_isnil(L, -2)) return 1; // error message
+  const char *filename = lua_tostring(L, -2);
+  if (lL_loadfile(L, filename) != LUA_OK)
+    return luaL_error(L, "error loading module '%s' from file '%s':\n\t%s",
+                      name, filename, lua_tostring(L, -1));
+  return (lua_pushstring(L, filename), 2);
+}
+
+/**
+ * `_G.loadfile()` Lua function that loads files through the bytecode cache.
+ * Calls Lua's own `loadfile()`, the closure's upvalue, when given a mode or
+ * environment.
+ */
+static int lloadfile(lua_State *L) {
+  if (lua_gettop(L) == 1 && lua_type(L, 1) == LUA_TSTRING) {
+    if (lL_loadfile(L, lua_tostring(L, 1)) == LUA_OK) return 1;
+    return (lua_pushnil(L), lua_insert(L, -2), 2);
+  }
+  lua_pushvalue(L, lua_upvalueindex(1)), lua_insert(L, 1);
+  lua_call(L, lua_gettop(L) - 1, LUA_MULTRET);
+  return lua_gettop(L);
+}
+
+/**
+ * Loads and runs the given file.
+ * @param L The Lua state.
+ * @param filename The file name relative to textadept_home.
+ * @return 1 if there are no errors or 0 in case of errors.
+ */
+static int lL_dofile(lua_State *L, const char *filename) {
+  char *file = malloc(strlen(textadept_home) + 1 + strlen(filename) + 1);
+  stpcpy(stpcpy(stpcpy(file, textadept_home), "/"), filename);
+  trace_begin("lua", filename, 0);
+  int ok = (lL_loadfile(L, file) == LUA_OK &&
+            lua_pcall(L, 0, LUA_MULTRET, 0) == LUA_OK);
+  trace_finish();
+  if (!ok) {
+#if GTK
+    GtkWidget *dialog = gtk_message_dialog_new(NULL, GTK_DIALOG_MODAL,
+                                               GTK_MESSAGE_ERROR,
+                                               GTK_BUTTONS_OK, "%s\n",
+                                               lua_tostring(L, -1));
+    gtk_dialog_run(GTK_DIALOG(dialog)), gtk_widget_destroy(dialog);
+#elif CURSES
+    WINDOW *win = newwin(0, 0, 1, 0);
+    wprintw(win, "%s\n", lua_tostring(L, -1)), wrefresh(win);
+    getch(), delwin(win);
+#endif
+    lua_settop(L, 0);
+  }
+  free(file);
+  return ok;
+}
+
+/** `_G.reset()` Lua function. */
+static int lreset(lua_State *L) {
+  finish_saves(L, TRUE);
+  lL_event(L, "reset_before", -1);
+  lL_init(L, 0, NULL, TRUE);
+  l_setglobalview(L, focused_view);
+  l_setglobaldoc(L, SS(focused_view, SCI_GETDOCPOINTER, 0, 0));
+  lua_pushnil(L), lua_setglobal(L, "arg");
+  lL_dofile(L, "init.lua"), lL_event(L, "initialized", -1);
+  lua_getfield(L, LUA_REGISTRYINDEX, "ta_arg"), lua_setglobal(L, "arg");
+  lL_event(L, "reset_after", -1);
+  return 0;
+}
+
+#if GTK
+static int emit_timeout(void *data) {
+  int *refs = (int *)data;
+  lua_rawgeti(lua, LUA_REGISTRYINDEX, refs[0]); // function
+  int nargs = 0, repeat = TRUE;
+  while (refs[++nargs]) lua_rawgeti(lua, LUA_REGISTRYINDEX, refs[nargs]);
+  int ok = (lua_pcall(lua, nargs - 1, 1, 0) == LUA_OK);
+  if (!ok || !lua_toboolean(lua, -1)) {
+    while (--nargs >= 0) luaL_unref(lua, LUA_REGISTRYINDEX, refs[nargs]);
+    repeat = FALSE;
+    if (!ok) lL_event(lua, "error", LUA_TSTRING, lua_tostring(lua, -1), -1);
+  }
+  lua_pop(lua, 1); // result
+  return repeat;
+}
+#endif
+
+/** `trace.start()` Lua function. */
+static int ltrace_start(lua_State *L) {
+  lua_Integer size = luaL_optinteger(L, 1, 65536);
+  luaL_argcheck(L, size > 0 && size <= MAX_SPANS, 1,
+                "size must be between 1 and 4194304");
+  Span *new_spans = realloc(spans, size * sizeof(Span));
+  if (!new_spans) return luaL_error(L, "not enough memory");
+  spans = new_spans, max_spans = size;
+  return (num_spans = 0, num_open_spans = 0, tracing = TRUE, 0);
+}
+
+/** `trace.stop()` Lua function. */
+static int ltrace_stop(lua_State *L) { return (tracing = FALSE, 0); }
+
+/** `trace.begin()` Lua function. */
+static int ltrace_begin(lua_State *L) {
+  return (trace_begin("lua", luaL_checkstring(L, 1), 0), 0);
+}
+
+/** `trace.finish()` Lua function. */
+static int ltrace_finish(lua_State *L) { return (trace_finish(), 0); }
+
+/** `trace.clock()` Lua function. */
+static int ltrace_clock(lua_State *L) {
+  return (lua_pushinteger(L, l_nanotime()), 1);
+}
+
+/**
+ * Writes the given string to the given file as a JSON string.
+ * @param f The file to write to.
+ * @param s The string to write.
+ */
+static void fputs_json(FILE *f, const char *s) {
+  fputc('"', f);
+  for (; *s; s++)
+    if (*s == '"' || *s == '\\')
+      fprintf(f, "\\%c", *s);
+    else if ((unsigned char)*s < 0x20)
+      fprintf(f, "\\u%04x", *s);
+    else
+      fputc(*s, f);
+  fputc('"', f);
+}
+
+/** `trace.dump()` Lua function. */
+static int ltrace_dump(lua_State *L) {
+  const char *filename = luaL_checkstring(L, 1);
+  FILE *f = fopen(filename, "w");
+  if (!f) return (lua_pushnil(L), lua_pushstring(L, strerror(errno)), 2);
+  lua_settop(L, 1);
+  // Map Scintilla messages back to function and property names.
+  lua_newtable(L);
+  for (int i = 0; i < iface_functions.size; i++) {
+    const IfaceEntry *entry = &iface_functions.entries[i];
+    lua_pushstring(L, entry->name), lua_rawseti(L, -2, entry->values[0]);
+  }
+  for (int i = 0; i < iface_properties.size; i++) {
+    const IfaceEntry *entry = &iface_properties.entries[i];
+    for (int j = 0; j < 2; j++)
+      if (entry->values[j] > 0)
+        lua_pushstring(L, entry->name), lua_rawseti(L, -2, entry->values[j]);
+  }
+  size_t first = (num_spans > max_spans) ? num_spans - max_spans : 0;
+  // Spans are recorded as they finish, so an enclosing span starts before the
+  // spans recorded ahead of it.
+  long long start = (num_spans > 0) ? spans[first % max_spans].start : 0;
+  for (size_t i = first; i < num_spans; i++)
+    if (spans[i % max_spans].start < start) start = spans[i % max_spans].start;
+  fputs("{\"traceEvents\":[", f);
+  for (size_t i = first; i < num_spans; i++) {
+    Span *span = &spans[i % max_spans];
+    const char *name = span->name;
+    if (span->msg) {
+      lua_rawgeti(L, -1, span->msg);
+      name = lua_isstring(L, -1) ? lua_tostring(L, -1) : "?";
+    }
+    fprintf(f, "%s\n{\"name\":", (i > first) ? "," : "");
+    fputs_json(f, name), lua_settop(L, 2);
+    fprintf(f, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+            "\"pid\":1,\"tid\":1}", span->category,
+            (span->start - start) / 1e3, span->duration / 1e3);
+  }
+  fputs("\n]}\n", f), fclose(f);
+  return (lua_pushboolean(L, TRUE), 1);
+}
+
+#if __linux__
+/**
+ * Reads pending inotify events and marks the watched files they are for as
+ * changed.
+ * When the watch on a directory is removed, as when it is deleted or its file
+ * system is unmounted, its files are no longer watched and are marked as
+ * changed too.
+ * @return `TRUE` if any watched file changed, `FALSE` otherwise
+ */
+static int read_watch_events() {
+  union { struct inotify_event event; char buf[4096]; } events;
+  int changed = FALSE, len;
+  while ((len = read(watch_fd, events.buf, sizeof(events.buf))) > 0)
+    for (char *p = events.buf; p < events.buf + len;) {
+      struct inotify_event *event = (struct inotify_event *)p;
+      for (int i = 0; i < num_watched_files; i++) {
+        WatchedFile *file = &watched_files[i];
+        if ((event->mask & IN_Q_OVERFLOW) ||
+            (file->wd == event->wd && event->len > 0 &&
+             strcmp(file->name, event->name) == 0))
+          file->changed = changed = TRUE;
+        else if ((event->mask & IN_IGNORED) && file->wd == event->wd)
+          file->wd = -1, file->changed = changed = TRUE;
+      }
+      p += sizeof(struct inotify_event) + event->len;
+    }
+  return changed;
+}
+
+/**
+ * Emits a 'file_modified' event for each watched file marked as changed, along
+ * with whether or not the file is no longer watched.
+ */
+static void emit_watch_events() {
+  for (int i = 0; i < num_watched_files; i++) {
+    if (!watched_files[i].changed) continue;
+    watched_files[i].changed = FALSE;
+    char *filename = watched_files[i].filename;
+    int unwatched = watched_files[i].wd < 0;
+    if (unwatched)
+      memmove(watched_files + i, watched_files + i + 1,
+              (--num_watched_files - i) * sizeof(WatchedFile));
+    lL_event(lua, "file_modified", LUA_TSTRING, filename, LUA_TBOOLEAN,
+             unwatched, -1);
+    if (unwatched) free(filename);
+    i = -1; // handlers may have watched or unwatched files, so start over
+  }
+}
+
+#if GTK
+/** Reports the watched files changed since watch_readable() was called. */
+static int watch_timeout(void*_) {
+  return (watch_timer = 0, emit_watch_events(), FALSE);
+}
+
+/**
+ * Signal for readable inotify events.
+ * Changes are reported `WATCH_DELAY` milliseconds after the first one so that a
+ * burst of them is reported once.
+ */
+static int watch_readable(GIOChannel*_, GIOCondition __, void*___) {
+  if (read_watch_events() && !watch_timer)
+    watch_timer = g_timeout_add(WATCH_DELAY, watch_timeout, NULL);
+  return TRUE;
+}
+#endif
+#endif
+
+/** `io._watch_file()` Lua function. */
+static int lio_watch_file(lua_State *L) {
+  const char *filename = luaL_checkstring(L, 1);
+#if __linux__
+  for (int i = 0; i < num_watched_files; i++)
+    if (strcmp(watched_files[i].filename, filename) == 0)
+      return (lua_pushboolean(L, TRUE), 1);
+  if (watch_fd < 0) {
+    watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#if GTK
+    if (watch_fd >= 0) {
+      GIOChannel *channel = g_io_channel_unix_new(watch_fd);
+      g_io_add_watch(channel, G_IO_IN, watch_readable, NULL);
+      g_io_channel_unref(channel);
+    }
+#endif
+  }
+  const char *name = strrchr(filename, '/');
+  if (watch_fd < 0 || !name) return (lua_pushboolean(L, FALSE), 1);
+  // Watch the file's directory for files created, written, or renamed.
+  char *dir = (name > filename) ? strndup(filename, name - filename) :
+                                  strdup("/");
+  int wd = inotify_add_watch(watch_fd, dir, IN_ATTRIB | IN_CLOSE_WRITE |
+                             IN_CREATE | IN_MODIFY | IN_MOVED_TO);
+  free(dir);
+  if (wd < 0) return (lua_pushboolean(L, FALSE), 1);
+  if (num_watched_files == max_watched_files) {
+    max_watched_files = max_watched_files ? 2 * max_watched_files : 16;
+    watched_files = realloc(watched_files,
+                            max_watched_files * sizeof(WatchedFile));
+  }
+  WatchedFile *file = &watched_files[num_watched_files++];
+  file->filename = strdup(filename);
+  file->name = file->filename + (name - filename) + 1;
+  file->wd = wd, file->changed = FALSE;
+  return (lua_pushboolean(L, TRUE), 1);
+#else
+  return (lua_pushboolean(L, FALSE), 1);
+#endif
+}
+
+/** `io._unwatch_file()` Lua function. */
+static int lio_unwatch_file(lua_State *L) {
+  const char *filename = luaL_checkstring(L, 1);
+#if __linux__
+  int i = 0, wd = -1;
+  while (i < num_watched_files &&
+         strcmp(watched_files[i].filename, filename) != 0) i++;
+  if (i == num_watched_files) return 0;
+  wd = watched_files[i].wd, free(watched_files[i].filename);
+  memmove(watched_files + i, watched_files + i + 1,
+          (--num_watched_files - i) * sizeof(WatchedFile));
+  if (wd < 0) return 0; // the directory's watch was already removed
+  // Stop watching the file's directory if no other watched file is in it.
+  for (i = 0; i < num_watched_files; i++)
+    if (watched_files[i].wd == wd) return 0;
+  inotify_rm_watch(watch_fd, wd);
+#endif
+  return 0;
+}
+
+// Find in files searches run by ui.find._search_files().
+#define MAX_SEARCH_THREADS 16
+#define SEARCH_INTERVAL 1000 // ms between calls to the search's Lua function
+
+/** The matches found in one file by a find in files search. */
+typedef struct {
+  char *text; // a "line:text\n" record per match, or NULL for a binary file
+  size_t len; // the length of that text
+  size_t (*ranges)[2]; // the position in its record and length of each match
+  int num_ranges;
+} SearchResult;
+
+/** A find in files search shared by the threads searching its files. */
+typedef struct {
+  const char *text; // the text to search for
+  size_t len; // the length of that text
+  int flags; // SCFIND_MATCHCASE, SCFIND_WHOLEWORD, and SCFIND_REGEXP
+  regex_t preg; // the compiled regex if flags has SCFIND_REGEXP
+  char **files; // the files to search
+  int num_files, next_file; // the number of files and the next one to search
+  SearchResult **results; // each file's matches, if any, once searched
+  char *searched; // whether or not each file has been searched
+  volatile int cancel; // whether or not to stop searching
+  int running; // the number of threads still searching
+#if GTK
+  GMutex *lock;
+  GCond *cond;
+#elif !_WIN32
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+#endif
+} Search;
+
+#if GTK
+#define search_lock(s) g_mutex_lock((s)->lock)
+#define search_unlock(s) g_mutex_unlock((s)->lock)
+#define search_signal(s) g_cond_signal((s)->cond)
+#elif !_WIN32
+#define search_lock(s) pthread_mutex_lock(&(s)->lock)
+#define search_unlock(s) pthread_mutex_unlock(&(s)->lock)
+#define search_signal(s) pthread_cond_signal(&(s)->cond)
+#else
+#define search_lock(s)
+#define search_unlock(s)
+#define search_signal(s)
+#endif
+
+/** Returns the given byte in lower case if it is an ASCII letter. */
+static unsigned char fold_byte(unsigned char c) {
+  return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+/**
+ * Returns whether or not the given byte is a word character, as it is for
+ * Scintilla by default.
+ */
+static int is_word_byte(unsigned char c) {
+  return (c >= '0' && c <= '9') || (fold_byte(c) >= 'a' && fold_byte(c) <= 'z')
+         || c == '_' || c >= 0x80;
+}
+
+/**
+ * Returns a pointer to the first occurrence of a search's literal text in the
+ * given text, or `NULL`.
+ * The text is scanned for the search text's first byte with memchr(), or, for a
+ * case-insensitive search starting with a letter, eight bytes at a time for
+ * either case of that letter. Only candidates are compared in full.
+ * @param search The search.
+ * @param p The text to search.
+ * @param end The end of that text.
+ */
+static const char *find_literal(Search *search, const char *p,
+                                const char *end) {
+  if ((size_t)(end - p) < search->len) return NULL;
+  const char *last = end - search->len, *s = search->text;
+  int icase = !(search->flags & SCFIND_MATCHCASE);
+  unsigned char lo = icase ? fold_byte(*s) : *s,
+                hi = (icase && lo >= 'a' && lo <= 'z') ? lo - 'a' + 'A' : lo;
+  while (p <= last) {
+    if (lo == hi) {
+      if (!(p = memchr(p, lo, last - p + 1))) return NULL;
+    } else if (last - p >= 8) {
+      uint64_t w;
+      memcpy(&w, p, 8);
+      if (!HAS_BYTE(w, lo) && !HAS_BYTE(w, hi)) {
+        p += 8;
+        continue;
+      }
+    }
+    if ((unsigned char)*p == lo || (unsigned char)*p == hi) {
+      size_t i = 1;
+      if (!icase)
+        i = (memcmp(p, s, search->len) == 0) ? search->len : 0;
+      else
+        while (i < search->len && fold_byte(p[i]) == fold_byte(s[i])) i++;
+      if (i == search->len) return p;
+    }
+    p++;
+  }
+  return NULL;
+}
+
+/**
+ * Returns a pointer to the first match of a search in the given file text at or
+ * after position `p`, or `NULL`.
+ * As with Scintilla, regex searches ignore SCFIND_WHOLEWORD.
+ * @param search The search.
+ * @param start The start of the file's text.
+ * @param p The position to search from.
+ * @param end The end of the file's text.
+ * @param len Pointer to the length of the match found.
  */
-static void new_buffer(sptr_t doc) {
-  if (!doc) {
-    doc = SS(focused_view, SCI_CREATEDOCUMENT, 0, 0); // create the new document
-    lL_event(lua, "buffer_before_switch", -1);
-    lL_adddoc(lua, doc);
-    lL_gotodoc(lua, focused_view, -1, FALSE);
-  } else lL_adddoc(lua, doc), SS(focused_view, SCI_ADDREFDOCUMENT, 0, doc);
-#if GTK
-  // Add a tab to the tabbar.
-  l_pushdoc(lua, SS(focused_view, SCI_GETDOCPOINTER, 0, 0));
-  lua_getfield(lua, -1, "tab_pointer");
-  GtkWidget *tab = (GtkWidget *)lua_touserdata(lua, -1);
-  tab_sync = TRUE;
-  int i = gtk_notebook_append_page(GTK_NOTEBOOK(tabbar), tab, NULL);
-  gtk_widget_show(tab), gtk_widget_set_visible(tabbar, show_tabs && i > 0);
-  gtk_notebook_set_current_page(GTK_NOTEBOOK(tabbar), i);
-  tab_sync = FALSE;
-  lua_pop(lua, 2); // tab_pointer and buffer
-//#elif CURSES
-  // TODO: tabs
-#endif
-  l_setglobaldoc(lua, doc);
-  if (!initing) lL_event(lua, "buffer_new", -1);
+static const char *find_match(Search *search, const char *start, const char *p,
+                              const char *end, size_t *len) {
+  if (search->flags & SCFIND_REGEXP) {
+    regmatch_t match;
+    int eflags = (p > start && p[-1] != '\n') ? REG_NOTBOL : 0;
+    if (tre_regnexec(&search->preg, p, end - p, 1, &match, eflags) != REG_OK)
+      return NULL;
+    *len = match.rm_eo - match.rm_so;
+    return p + match.rm_so;
+  }
+  *len = search->len;
+  for (; (p = find_literal(search, p, end)); p++)
+    if (!(search->flags & SCFIND_WHOLEWORD) ||
+        ((p == start || !is_word_byte(p[-1])) &&
+         (p + *len == end || !is_word_byte(p[*len]))))
+      return p;
+  return NULL;
 }
 
-/** `_G.quit()` Lua function. */
-static int lquit(lua_State *L) {
-#if GTK
-  GdkEventAny event = {GDK_DELETE, gtk_widget_get_window(window), TRUE};
-  gdk_event_put((GdkEvent *)&event);
-#elif CURSES
-  quit = TRUE;
-#endif
-  return 0;
+/**
+ * Searches a file and returns its matches, or `NULL` if it has none.
+ * Files are read in rather than mapped, since another program truncating a
+ * mapped file would crash Textadept with SIGBUS. If a file with a match has a
+ * NUL byte in its first 64 KB, it is considered binary and the search stops
+ * there.
+ * This may run in a separate thread, so it must not use Lua or Scintilla.
+ * @param search The search.
+ * @param filename The file to search.
+ */
+static SearchResult *search_file(Search *search, const char *filename) {
+  FILE *f = fopen(filename, "rb");
+  struct stat st;
+  if (!f) return NULL;
+  if (fstat(fileno(f), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+    return (fclose(f), NULL);
+  char *data = malloc(st.st_size);
+  if (!data) return (fclose(f), NULL);
+  size_t len = fread(data, 1, st.st_size, f);
+  SearchResult *result = NULL;
+  const char *p = data, *end = data + len, *line = data, *eol;
+  size_t line_num = 1, match_len, size = 0;
+  int max_ranges = 0;
+  while (!search->cancel &&
+         (p = find_match(search, data, p, end, &match_len))) {
+    if (!result) {
+      result = calloc(1, sizeof(SearchResult));
+      if (memchr(data, '\0', (len < 65536) ? len : 65536)) break; // binary
+    }
+    // Append a "line:text\n" record for the match's line.
+    for (; (eol = memchr(line, '\n', p - line)); line = eol + 1) line_num++;
+    eol = memchr(p, '\n', end - p);
+    size_t line_len = (eol ? eol + 1 : end) - line;
+    if (result->len + line_len + 32 > size) {
+      size = 2 * (result->len + line_len + 32);
+      result->text = realloc(result->text, size);
+    }
+    if (result->num_ranges == max_ranges) {
+      max_ranges = max_ranges ? 2 * max_ranges : 16;
+      result->ranges = realloc(result->ranges,
+                               max_ranges * sizeof(*result->ranges));
+    }
+    int n = sprintf(result->text + result->len, "%lu:",
+                    (unsigned long)line_num);
+    memcpy(result->text + result->len + n, line, line_len);
+    result->len += n + line_len;
+    if (!eol) result->text[result->len++] = '\n';
+    size_t col = p - line, max = line_len - col;
+    result->ranges[result->num_ranges][0] = n + col;
+    result->ranges[result->num_ranges++][1] = (match_len < max) ? match_len :
+                                                                  max;
+    p += match_len ? match_len : 1;
+  }
+  free(data);
+  return (fclose(f), result);
 }
 
-#if _WIN32
-char *stpcpy(char *dest, const char *src) {
-  return (strcpy(dest, src), dest + strlen(src));
+/**
+ * Searches files for a search until all of them have been searched or the
+ * search is canceled.
+ * @param search The search.
+ */
+static void *search_thread(void *data) {
+  Search *search = data;
+  search_lock(search);
+  while (!search->cancel && search->next_file < search->num_files) {
+    int i = search->next_file++;
+    search_unlock(search);
+    SearchResult *result = search_file(search, search->files[i]);
+    search_lock(search);
+    search->results[i] = result, search->searched[i] = TRUE;
+    search_signal(search);
+  }
+  search->running--, search_signal(search);
+  search_unlock(search);
+  return NULL;
 }
-#endif
 
 /**
- * Loads and runs the given file.
- * @param L The Lua state.
- * @param filename The file name relative to textadept_home.
- * @return 1 if there are no errors or 0 in case of errors.
+ * Waits up to SEARCH_INTERVAL milliseconds for a search's file to be searched.
+ * If no threads are searching files, searches the next file instead.
+ * @param search The search.
+ * @param i The index of the file to wait for.
  */
-static int lL_dofile(lua_State *L, const char *filename) {
-  char *file = malloc(strlen(textadept_home) + 1 + strlen(filename) + 1);
-  stpcpy(stpcpy(stpcpy(file, textadept_home), "/"), filename);
-  int ok = (luaL_dofile(L, file) == LUA_OK);
-  if (!ok) {
-#if GTK
-    GtkWidget *dialog = gtk_message_dialog_new(NULL, GTK_DIALOG_MODAL,
-                                               GTK_MESSAGE_ERROR,
-                                               GTK_BUTTONS_OK, "%s\n",
-                                               lua_tostring(L, -1));
-    gtk_dialog_run(GTK_DIALOG(dialog)), gtk_widget_destroy(dialog);
-#elif CURSES
-    WINDOW *win = newwin(0, 0, 1, 0);
-    wprintw(win, "%s\n", lua_tostring(L, -1)), wrefresh(win);
-    getch(), delwin(win);
+static void wait_for_file(Search *search, int i) {
+  if (search->searched[i]) return;
+  if (!search->running) {
+    int j = search->next_file++;
+    search->results[j] = search_file(search, search->files[j]);
+    search->searched[j] = TRUE;
+    return;
+  }
+#if GTK && GLIB_CHECK_VERSION(2,32,0)
+  gint64 deadline = g_get_monotonic_time() + SEARCH_INTERVAL * 1000;
+  while (!search->searched[i] &&
+         g_cond_wait_until(search->cond, search->lock, deadline)) ;
+#elif GTK
+  GTimeVal deadline;
+  g_get_current_time(&deadline);
+  g_time_val_add(&deadline, SEARCH_INTERVAL * 1000);
+  while (!search->searched[i] &&
+         g_cond_timed_wait(search->cond, search->lock, &deadline)) ;
+#elif !_WIN32
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += SEARCH_INTERVAL / 1000;
+  while (!search->searched[i] &&
+         pthread_cond_timedwait(&search->cond, &search->lock, &deadline) == 0) ;
 #endif
-    lua_settop(L, 0);
+}
+
+/**
+ * Appends the given text to a malloc()ed buffer, doubling the buffer's size as
+ * needed.
+ * @param buf Pointer to the buffer, which may be reallocated.
+ * @param size Pointer to the size of the buffer.
+ * @param len Pointer to the length of the buffer's contents.
+ * @param s The text to append.
+ * @param n The length of that text.
+ */
+static void append_bytes(char **buf, size_t *size, size_t *len, const char *s,
+                         size_t n) {
+  if (*len + n > *size) {
+    while (*len + n > *size) *size = *size ? 2 * *size : 4096;
+    *buf = realloc(*buf, *size);
   }
-  free(file);
-  return ok;
+  memcpy(*buf + *len, s, n), *len += n;
 }
 
-/** `_G.reset()` Lua function. */
-static int lreset(lua_State *L) {
-  lL_event(L, "reset_before", -1);
-  lL_init(L, 0, NULL, TRUE);
-  l_setglobalview(L, focused_view);
-  l_setglobaldoc(L, SS(focused_view, SCI_GETDOCPOINTER, 0, 0));
-  lua_pushnil(L), lua_setglobal(L, "arg");
-  lL_dofile(L, "init.lua"), lL_event(L, "initialized", -1);
-  lua_getfield(L, LUA_REGISTRYINDEX, "ta_arg"), lua_setglobal(L, "arg");
-  lL_event(L, "reset_after", -1);
-  return 0;
+/**
+ * Pushes onto the Lua stack the "filename:line:text\n" lines for the matches of
+ * the given searched files, and a table of the position and length of each
+ * match in those lines, and then frees those files' results.
+ * @param L The Lua state.
+ * @param search The search.
+ * @param first The index of the first file.
+ * @param last The index after that of the last file.
+ * @param binary_text The text of the line for a binary file with a match.
+ * @param cd The descriptor for converting filenames to UTF-8, or `(iconv_t)-1`.
+ */
+static void lL_pushsearchresults(lua_State *L, Search *search, int first,
+                                 int last, const char *binary_text,
+                                 iconv_t cd) {
+  char *text = NULL, *name = malloc(256);
+  size_t size = 0, len = 0, name_size = 256;
+  lua_newtable(L);
+  for (int i = first, n = 1; i < last; i++) {
+    SearchResult *result = search->results[i];
+    if (!result) continue;
+    ICONV_IN inbuf = (ICONV_IN)search->files[i];
+    size_t inbytesleft = strlen(search->files[i]), name_len = 0;
+    if (cd == (iconv_t)-1 ||
+        iconv_append(cd, &inbuf, &inbytesleft, &name, &name_size,
+                     &name_len) != 0) {
+      name_len = 0;
+      append_bytes(&name, &name_size, &name_len, search->files[i],
+                   strlen(search->files[i]));
+    }
+    append_bytes(&name, &name_size, &name_len, ":", 1);
+    if (!result->text) {
+      append_bytes(&text, &size, &len, name, name_len);
+      append_bytes(&text, &size, &len, "1:", 2);
+      append_bytes(&text, &size, &len, binary_text, strlen(binary_text));
+      append_bytes(&text, &size, &len, "\n", 1);
+    }
+    const char *record = result->text;
+    for (int j = 0; j < result->num_ranges; j++) {
+      const char *next = (const char *)memchr(record, '\n', result->text +
+                                              result->len - record) + 1;
+      lua_pushinteger(L, len + name_len + result->ranges[j][0]);
+      lua_rawseti(L, -2, n++);
+      lua_pushinteger(L, result->ranges[j][1]), lua_rawseti(L, -2, n++);
+      append_bytes(&text, &size, &len, name, name_len);
+      append_bytes(&text, &size, &len, record, next - record);
+      record = next;
+    }
+    free(result->text), free(result->ranges), free(result);
+    search->results[i] = NULL;
+  }
+  lua_pushlstring(L, text, len), lua_insert(L, -2);
+  free(text), free(name);
 }
 
+/** `ui.find._search_files()` Lua function. */
+static int lfind_search_files(lua_State *L) {
+  luaL_checktype(L, 1, LUA_TTABLE);
+  Search search = {0};
+  search.text = luaL_checklstring(L, 2, &search.len);
+  search.flags = luaL_checkinteger(L, 3);
+  const char *binary_text = luaL_checkstring(L, 4);
+  luaL_checktype(L, 5, LUA_TFUNCTION);
+  if (search.len == 0) return 0;
+  if (search.flags & SCFIND_REGEXP) {
+    int cflags = REG_EXTENDED | REG_NEWLINE |
+                 (!(search.flags & SCFIND_MATCHCASE) ? REG_ICASE : 0);
+    if (tre_regncomp(&search.preg, search.text, search.len, cflags) != REG_OK)
+      return 0; // as with Scintilla, an invalid regex matches nothing
+  }
+  search.num_files = lua_rawlen(L, 1);
+  search.files = malloc(search.num_files * sizeof(char *));
+  for (int i = 0; i < search.num_files; i++) {
+    lua_rawgeti(L, 1, i + 1);
+    search.files[i] = strdup(luaL_optstring(L, -1, "")), lua_pop(L, 1);
+  }
+  search.results = calloc(search.num_files, sizeof(SearchResult *));
+  search.searched = calloc(search.num_files, 1);
+  lua_getglobal(L, "_CHARSET");
+  const char *charset = luaL_optstring(L, -1, "UTF-8");
+  iconv_t cd = !is_encoding(charset, "UTF8") ?
+    iconv_acquire("UTF-8", charset) : (iconv_t)-1;
+
+  // Search files in as many threads as there are processors. The terminal
+  // version on Windows searches them one at a time instead.
+  int num_threads = 0;
 #if GTK
-static int emit_timeout(void *data) {
-  int *refs = (int *)data;
-  lua_rawgeti(lua, LUA_REGISTRYINDEX, refs[0]); // function
-  int nargs = 0, repeat = TRUE;
-  while (refs[++nargs]) lua_rawgeti(lua, LUA_REGISTRYINDEX, refs[nargs]);
-  int ok = (lua_pcall(lua, nargs - 1, 1, 0) == LUA_OK);
-  if (!ok || !lua_toboolean(lua, -1)) {
-    while (--nargs >= 0) luaL_unref(lua, LUA_REGISTRYINDEX, refs[nargs]);
-    repeat = FALSE;
-    if (!ok) lL_event(lua, "error", LUA_TSTRING, lua_tostring(lua, -1), -1);
+#if GLIB_CHECK_VERSION(2,36,0)
+  num_threads = g_get_num_processors();
+#elif !_WIN32
+  num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+  SYSTEM_INFO info;
+  GetSystemInfo(&info), num_threads = info.dwNumberOfProcessors;
+#endif
+  GThread *threads[MAX_SEARCH_THREADS];
+#if GLIB_CHECK_VERSION(2,32,0)
+  GMutex lock;
+  GCond cond;
+  g_mutex_init(search.lock = &lock), g_cond_init(search.cond = &cond);
+#else
+  search.lock = g_mutex_new(), search.cond = g_cond_new();
+#endif
+#elif !_WIN32
+  num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+  pthread_t threads[MAX_SEARCH_THREADS];
+  pthread_mutex_init(&search.lock, NULL), pthread_cond_init(&search.cond, NULL);
+#endif
+  if (num_threads > MAX_SEARCH_THREADS) num_threads = MAX_SEARCH_THREADS;
+  if (num_threads > search.num_files) num_threads = search.num_files;
+  search_lock(&search);
+  for (int i = 0; i < num_threads; i++) {
+#if GTK
+    threads[i] = g_thread_new("search", search_thread, &search);
+#elif !_WIN32
+    if (pthread_create(&threads[i], NULL, search_thread, &search) != 0) break;
+#endif
+    search.running++;
   }
-  lua_pop(lua, 1); // result
-  return repeat;
-}
+  num_threads = search.running;
+
+  // Report the matches of searched files in order, along with any matches of
+  // other files searched by then, calling the Lua function at least every
+  // SEARCH_INTERVAL milliseconds until it returns `false`.
+  int reported = 0, ok = TRUE;
+  long long last_call = l_nanotime();
+  while (reported < search.num_files && ok) {
+    wait_for_file(&search, reported);
+    int first = reported;
+    while (reported < search.num_files && search.searched[reported])
+      reported++;
+    int found = FALSE;
+    for (int i = first; i < reported && !found; i++)
+      if (search.results[i]) found = TRUE;
+    if (!found && (l_nanotime() - last_call) / 1000000 < SEARCH_INTERVAL)
+      continue;
+    search_unlock(&search);
+    lua_pushvalue(L, 5);
+    if (found)
+      lL_pushsearchresults(L, &search, first, reported, binary_text, cd);
+    ok = lua_pcall(L, found ? 2 : 0, 1, 0) == LUA_OK;
+    if (ok && lua_isboolean(L, -1) && !lua_toboolean(L, -1)) ok = FALSE;
+    else if (ok) lua_pop(L, 1); // return value
+    last_call = l_nanotime();
+    search_lock(&search);
+  }
+  search.cancel = TRUE;
+  search_unlock(&search);
+
+#if GTK
+  for (int i = 0; i < num_threads; i++) g_thread_join(threads[i]);
+#if GLIB_CHECK_VERSION(2,32,0)
+  g_mutex_clear(search.lock), g_cond_clear(search.cond);
+#else
+  g_mutex_free(search.lock), g_cond_free(search.cond);
+#endif
+#elif !_WIN32
+  for (int i = 0; i < num_threads; i++) pthread_join(threads[i], NULL);
+  pthread_mutex_destroy(&search.lock), pthread_cond_destroy(&search.cond);
 #endif
+  for (int i = 0; i < search.num_files; i++) {
+    if (search.results[i])
+      free(search.results[i]->text), free(search.results[i]->ranges),
+      free(search.results[i]);
+    free(search.files[i]);
+  }
+  free(search.files), free(search.results), free(search.searched);
+  if (search.flags & SCFIND_REGEXP) tre_regfree(&search.preg);
+  if (cd != (iconv_t)-1) iconv_release("UTF-8", charset, cd);
+  return (!ok && !lua_isboolean(L, -1)) ? lua_error(L) : 0;
+}
 
 /** `_G.timeout()` Lua function. */
 static int ltimeout(lua_State *L) {
@@ -1474,31 +3946,204 @@ static int ltimeout(lua_State *L) {
 /** `string.iconv()` Lua function. */
 static int lstring_iconv(lua_State *L) {
   size_t inbytesleft = 0;
-#if !_WIN32
-  char *inbuf = (char *)luaL_checklstring(L, 1, &inbytesleft);
-#else
-  const char *inbuf = luaL_checklstring(L, 1, &inbytesleft);
-#endif
+  ICONV_IN inbuf = (ICONV_IN)luaL_checklstring(L, 1, &inbytesleft);
   const char *to = luaL_checkstring(L, 2), *from = luaL_checkstring(L, 3);
-  iconv_t cd = iconv_open(to, from);
-  if (cd != (iconv_t)-1) {
-    char *outbuf = malloc(inbytesleft + 1), *p = outbuf;
-    size_t outbytesleft = inbytesleft, bufsize = inbytesleft;
-    int n = 1; // concat this many converted strings
-    while (iconv(cd, &inbuf, &inbytesleft, &p, &outbytesleft) == (size_t)-1)
-      if (errno == E2BIG) {
-        // Buffer was too small to store converted string. Push the partially
-        // converted string for later concatenation.
-        lua_checkstack(L, 2), lua_pushlstring(L, outbuf, p - outbuf), n++;
-        p = outbuf, outbytesleft = bufsize;
-      } else free(outbuf), iconv_close(cd), luaL_error(L, "conversion failed");
-    lua_pushlstring(L, outbuf, p - outbuf);
-    lua_concat(L, n);
-    free(outbuf), iconv_close(cd);
-  } else luaL_error(L, "invalid encoding(s)");
+  iconv_t cd = iconv_acquire(to, from);
+  if (cd == (iconv_t)-1) luaL_error(L, "invalid encoding(s)");
+  // Converted text is usually about as long as the original.
+  size_t size = inbytesleft + 16, len = 0;
+  char *outbuf = malloc(size);
+  int err = iconv_append(cd, &inbuf, &inbytesleft, &outbuf, &size, &len);
+  if (!err) err = iconv_append(cd, NULL, NULL, &outbuf, &size, &len);
+  iconv_release(to, from, cd);
+  if (err) free(outbuf), luaL_error(L, "conversion failed");
+  lua_pushlstring(L, outbuf, len), free(outbuf);
+  return 1;
+}
+
+/** A character set conversion stream created by `string.iconv_stream()`. */
+typedef struct {
+  const char *to, *from; // point to storage after this struct
+  iconv_t cd; // (iconv_t)-1 when finished
+  char pending[16]; // incomplete multibyte sequence ending the last chunk
+  size_t num_pending;
+} IconvStream;
+
+/**
+ * Returns the conversion stream at the given stack index, raising an error if
+ * the value is not a stream or if the stream is finished.
+ * @param L The Lua state.
+ * @param index The stack index of the stream.
+ */
+static IconvStream *lL_checkiconvstream(lua_State *L, int index) {
+  IconvStream *stream = (IconvStream *)luaL_checkudata(L, index,
+                                                       "ta_iconvstream");
+  luaL_argcheck(L, stream->cd != (iconv_t)-1, index, "stream is finished");
+  return stream;
+}
+
+/** `stream.feed()` Lua function. */
+static int liconvstream_feed(lua_State *L) {
+  IconvStream *stream = lL_checkiconvstream(L, 1);
+  luaL_checkstring(L, 2);
+  if (stream->num_pending > 0) {
+    // Prepend the incomplete sequence left over from the previous chunk.
+    lua_pushlstring(L, stream->pending, stream->num_pending);
+    lua_pushvalue(L, 2), lua_concat(L, 2), lua_replace(L, 2);
+    stream->num_pending = 0;
+  }
+  size_t inbytesleft = 0;
+  ICONV_IN inbuf = (ICONV_IN)lua_tolstring(L, 2, &inbytesleft);
+  size_t size = inbytesleft + 16, len = 0;
+  char *outbuf = malloc(size);
+  int err = iconv_append(stream->cd, &inbuf, &inbytesleft, &outbuf, &size,
+                         &len);
+  if (err == EINVAL && inbytesleft <= sizeof(stream->pending)) {
+    memcpy(stream->pending, inbuf, inbytesleft);
+    stream->num_pending = inbytesleft, err = 0;
+  }
+  if (err) free(outbuf), luaL_error(L, "conversion failed");
+  lua_pushlstring(L, outbuf, len), free(outbuf);
+  return 1;
+}
+
+/** `stream.finish()` Lua function. */
+static int liconvstream_finish(lua_State *L) {
+  IconvStream *stream = lL_checkiconvstream(L, 1);
+  size_t size = 16, len = 0;
+  char *outbuf = malloc(size);
+  int err = (stream->num_pending > 0) ? EINVAL :
+            iconv_append(stream->cd, NULL, NULL, &outbuf, &size, &len);
+  iconv_release(stream->to, stream->from, stream->cd);
+  stream->cd = (iconv_t)-1;
+  if (err) free(outbuf), luaL_error(L, "conversion failed");
+  lua_pushlstring(L, outbuf, len), free(outbuf);
+  return 1;
+}
+
+/** `stream.__gc` Lua metamethod. */
+static int liconvstream__gc(lua_State *L) {
+  IconvStream *stream = (IconvStream *)lua_touserdata(L, 1);
+  if (stream->cd != (iconv_t)-1)
+    iconv_release(stream->to, stream->from, stream->cd);
+  return 0;
+}
+
+/** `string.iconv_stream()` Lua function. */
+static int lstring_iconv_stream(lua_State *L) {
+  const char *to = luaL_checkstring(L, 1), *from = luaL_checkstring(L, 2);
+  size_t to_len = strlen(to), from_len = strlen(from);
+  IconvStream *stream = (IconvStream *)lua_newuserdata(
+    L, sizeof(IconvStream) + to_len + from_len + 2);
+  char *names = (char *)(stream + 1);
+  stream->to = strcpy(names, to);
+  stream->from = strcpy(names + to_len + 1, from);
+  stream->num_pending = 0;
+  stream->cd = iconv_acquire(to, from);
+  if (stream->cd == (iconv_t)-1) luaL_error(L, "invalid encoding(s)");
+  if (luaL_newmetatable(L, "ta_iconvstream")) {
+    l_setcfunction(L, -1, "__gc", liconvstream__gc);
+    lua_newtable(L);
+    l_setcfunction(L, -1, "feed", liconvstream_feed);
+    l_setcfunction(L, -1, "finish", liconvstream_finish);
+    lua_setfield(L, -2, "__index");
+  }
+  lua_setmetatable(L, -2);
   return 1;
 }
 
+/** `string.classify()` Lua function. */
+static int lstring_classify(lua_State *L) {
+  size_t len;
+  const char *text = luaL_checklstring(L, 1, &len);
+  TextInfo info;
+  classify_text(text, len, &info);
+  lua_createtable(L, 0, 6);
+  lua_pushboolean(L, info.binary), lua_setfield(L, -2, "binary");
+  lua_pushboolean(L, info.ascii), lua_setfield(L, -2, "ascii");
+  lua_pushboolean(L, info.utf8), lua_setfield(L, -2, "utf8");
+  if (info.bom) lua_pushstring(L, info.bom), lua_setfield(L, -2, "bom");
+  lua_pushinteger(L, info.lf), lua_setfield(L, -2, "lf");
+  lua_pushinteger(L, info.crlf), lua_setfield(L, -2, "crlf");
+  return 1;
+}
+
+/**
+ * Pushes onto the stack the Lua value of the given interface table entry.
+ * Constants are numbers, and functions and properties are tables of the form
+ * `{msg, rtype, wtype, ltype}` and `{get_id, set_id, rtype, wtype}`,
+ * respectively.
+ * @param L The Lua state.
+ * @param table The interface table the entry belongs to.
+ * @param entry The interface table entry.
+ */
+static void l_pushifacevalue(lua_State *L, const IfaceTable *table,
+                             const IfaceEntry *entry) {
+  if (table->fields == 1) {
+    lua_pushinteger(L, entry->values[0]);
+    return;
+  }
+  lua_createtable(L, table->fields, 0);
+  for (int i = 0; i < table->fields; i++)
+    lua_pushinteger(L, entry->values[i]), lua_rawseti(L, -2, i + 1);
+}
+
+/**
+ * Fills the interface view at the given valid index with all of the entries of
+ * its interface table that it does not have yet.
+ * @param L The Lua state.
+ * @param index The absolute stack index of the view.
+ * @param table The interface table the view is of.
+ */
+static void l_filliface(lua_State *L, int index, const IfaceTable *table) {
+  for (int i = 0; i < table->size; i++)
+    if (lua_getfield(L, index, table->entries[i].name) == LUA_TNIL) {
+      lua_pop(L, 1); // nil
+      l_pushifacevalue(L, table, &table->entries[i]);
+      lua_setfield(L, index, table->entries[i].name);
+    } else lua_pop(L, 1);
+}
+
+/** `_SCINTILLA` view table's `__index` Lua metamethod. */
+static int liface__index(lua_State *L) {
+  const IfaceTable *table = lua_touserdata(L, lua_upvalueindex(1));
+  if (lua_type(L, 2) != LUA_TSTRING) return 0;
+  const IfaceEntry *entry = iface_lookup(table, lua_tostring(L, 2));
+  if (!entry) return 0;
+  l_pushifacevalue(L, table, entry);
+  lua_pushvalue(L, 2), lua_pushvalue(L, -2), lua_rawset(L, 1);
+  return 1;
+}
+
+/** `_SCINTILLA` view table's `__pairs` Lua metamethod. */
+static int liface__pairs(lua_State *L) {
+  l_filliface(L, 1, lua_touserdata(L, lua_upvalueindex(1)));
+  lua_getglobal(L, "next"), lua_pushvalue(L, 1), lua_pushnil(L);
+  return 3;
+}
+
+/**
+ * Pushes onto the stack a view of the given compiled Scintilla interface
+ * table.
+ * The view starts out empty and creates entries as they are accessed, so
+ * Textadept does not build all of the interface's tables at startup. LuaJIT
+ * does not support `__pairs`, so in that case the view is filled immediately.
+ * @param L The Lua state.
+ * @param table The interface table to view.
+ */
+static void l_pushifaceview(lua_State *L, const IfaceTable *table) {
+  lua_createtable(L, 0, 0);
+  lua_createtable(L, 0, 2);
+  lua_pushlightuserdata(L, (void *)table);
+  lua_pushcclosure(L, liface__index, 1), lua_setfield(L, -2, "__index");
+  lua_pushlightuserdata(L, (void *)table);
+  lua_pushcclosure(L, liface__pairs, 1), lua_setfield(L, -2, "__pairs");
+  lua_setmetatable(L, -2);
+#if LUA_VERSION_NUM < 502
+  l_filliface(L, lua_gettop(L), table);
+#endif
+}
+
 /**
  * Clears a table at the given valid index by setting all of its keys to nil.
  * @param L The Lua state.
@@ -1520,6 +4165,10 @@ static void lL_cleartable(lua_State *L, int index) {
  * @return TRUE on success, FALSE otherwise.
  */
 static int lL_init(lua_State *L, int argc, char **argv, int reinit) {
+  lua_pushnil(L), lua_setfield(L, LUA_REGISTRYINDEX, "ta_eventlists");
+  lua_pushnil(L), lua_setfield(L, LUA_REGISTRYINDEX, "ta_scnotifications");
+  profile_events = FALSE, slow_handler_time = 0;
+  num_bulk_scopes = 0, num_modified_ranges = 0;
   if (!reinit) {
     lua_newtable(L);
     for (int i = 0; i < argc; i++)
@@ -1542,6 +4191,14 @@ static int lL_init(lua_State *L, int argc, char **argv, int reinit) {
   lua_pushinteger(L, (sptr_t)L), lua_setglobal(L, "_LUA");
   luaL_openlibs(L);
   lL_openlib(L, lpeg), lL_openlib(L, lfs), lL_openlib(L, spawn);
+  lua_getglobal(L, "package");
+  lua_getfield(L, -1, (LUA_VERSION_NUM == 501) ? "loaders" : "searchers");
+  lua_pushcfunction(L, lsearcher), lua_rawseti(L, -2, 2);
+  lua_pop(L, 2); // searchers, package
+  if (lua_getglobal(L, "loadfile"), lua_tocfunction(L, -1) != lloadfile)
+    lua_pushcclosure(L, lloadfile, 1), lua_setglobal(L, "loadfile");
+  else
+    lua_pop(L, 1); // loadfile
 
   lua_newtable(L);
   lua_newtable(L);
@@ -1550,12 +4207,13 @@ static int lL_init(lua_State *L, int argc, char **argv, int reinit) {
   l_setcfunction(L, -1, "focus", lfind_focus);
   l_setcfunction(L, -1, "replace", lfind_replace);
   l_setcfunction(L, -1, "replace_all", lfind_replace_all);
+  l_setcfunction(L, -1, "_search_files", lfind_search_files);
   l_setmetatable(L, -1, "ta_find", lfind__index, lfind__newindex);
   lua_setfield(L, -2, "find");
   if (!reinit) {
     lua_newtable(L);
     l_setcfunction(L, -1, "focus", lce_focus);
-    l_setmetatable(L, -1, "ta_buffer", lbuf_property, lbuf_property);
+    lL_setbuffermetatable(L, -1);
   } else {
     lua_getfield(L, LUA_REGISTRYINDEX, "ta_buffers");
     lua_rawgeti(L, -1, 0), lua_replace(L, -2); // _BUFFERS[0]
@@ -1575,9 +4233,31 @@ static int lL_init(lua_State *L, int argc, char **argv, int reinit) {
   lua_pop(L, 1); // _G
 
   lua_getglobal(L, "string");
+  l_setcfunction(L, -1, "classify", lstring_classify);
   l_setcfunction(L, -1, "iconv", lstring_iconv);
+  l_setcfunction(L, -1, "iconv_stream", lstring_iconv_stream);
   lua_pop(L, 1); // string
 
+  lua_getglobal(L, "io");
+  l_setcfunction(L, -1, "_watch_file", lio_watch_file); // undocumented
+  l_setcfunction(L, -1, "_unwatch_file", lio_unwatch_file); // undocumented
+  lua_pop(L, 1); // io
+
+  lua_newtable(L);
+  l_setcfunction(L, -1, "begin", ltrace_begin);
+  l_setcfunction(L, -1, "clock", ltrace_clock);
+  l_setcfunction(L, -1, "dump", ltrace_dump);
+  l_setcfunction(L, -1, "finish", ltrace_finish);
+  l_setcfunction(L, -1, "start", ltrace_start);
+  l_setcfunction(L, -1, "stop", ltrace_stop);
+  lua_setglobal(L, "trace");
+
+  lua_newtable(L);
+  l_pushifaceview(L, &iface_constants), lua_setfield(L, -2, "constants");
+  l_pushifaceview(L, &iface_functions), lua_setfield(L, -2, "functions");
+  l_pushifaceview(L, &iface_properties), lua_setfield(L, -2, "properties");
+  lua_setglobal(L, "_SCINTILLA");
+
   lua_getfield(L, LUA_REGISTRYINDEX, "ta_arg"), lua_setglobal(L, "arg");
   lua_getfield(L, LUA_REGISTRYINDEX, "ta_buffers");
   lua_setglobal(L, "_BUFFERS");
@@ -1605,14 +4285,21 @@ static int lL_init(lua_State *L, int argc, char **argv, int reinit) {
   lua_pushstring(L, charset), lua_setglobal(L, "_CHARSET");
 
   if (!lL_dofile(L, "core/init.lua")) return (lua_close(L), FALSE);
-  lua_getglobal(L, "_SCINTILLA");
-  lua_getfield(L, -1, "constants");
-  lua_setfield(L, LUA_REGISTRYINDEX, "ta_constants");
-  lua_getfield(L, -1, "functions");
-  lua_setfield(L, LUA_REGISTRYINDEX, "ta_functions");
-  lua_getfield(L, -1, "properties");
-  lua_setfield(L, LUA_REGISTRYINDEX, "ta_properties");
-  lua_pop(L, 1); // _SCINTILLA
+  lua_getglobal(L, "events"), lua_getfield(L, -1, "_handlers");
+  lua_setfield(L, LUA_REGISTRYINDEX, "ta_events");
+  lua_getfield(L, -1, "_scnotifications");
+  lua_setfield(L, LUA_REGISTRYINDEX, "ta_scnotifications");
+  lua_getfield(L, -1, "_scnotify");
+  lua_setfield(L, LUA_REGISTRYINDEX, "ta_scnotify");
+  lua_getfield(L, -1, "_stats");
+  lua_setfield(L, LUA_REGISTRYINDEX, "ta_eventstats");
+  l_setcfunction(L, -1, "_emit", levents__emit);
+  l_setcfunction(L, -1, "_monitor", levents__monitor);
+  lua_getfield(L, -1, "profile"), lua_getfield(L, -2, "slow_handler_time");
+  lua_pushcfunction(L, levents__monitor), lua_insert(L, -3);
+  lua_call(L, 2, 0); // pick up values set before now
+  lua_pop(L, 1); // events
+  lua_newtable(L), lua_setfield(L, LUA_REGISTRYINDEX, "ta_eventlists");
   return TRUE;
 }
 
@@ -1667,7 +4354,7 @@ static void lL_removeview(lua_State *L, Scintilla *view) {
  */
 static void delete_view(Scintilla *view) {
   lL_removeview(lua, view);
-  scintilla_delete(view);
+  scintilla_delete(view), clear_directs();
 }
 
 #if GTK
@@ -1790,6 +4477,7 @@ static int unsplit_view(Scintilla *view) {
  */
 static void l_close(lua_State *L) {
   closing = TRUE;
+  finish_saves(L, FALSE);
   while (unsplit_view(focused_view)) ; // need space to fix compiler warning
   lua_getfield(L, LUA_REGISTRYINDEX, "ta_buffers");
   for (size_t i = 1; i <= lua_rawlen(L, -1); i++)
@@ -1893,48 +4581,213 @@ static int t_tabbuttonpress(GtkWidget*_, GdkEventButton *event, void*__) {
 }
 #endif // if GTK
 
+/**
+ * Returns whether or not any handlers are connected to the event mapped to the
+ * given Scintilla notification code.
+ * The mapping comes from the 'ta_scnotifications' registry table
+ * (`events._scnotifications`).
+ * @param L The Lua state.
+ * @param code The Scintilla notification code.
+ * @return TRUE or FALSE
+ */
+static int l_hasnotificationhandlers(lua_State *L, int code) {
+  int top = lua_gettop(L), has_handlers = FALSE;
+  if (lua_getfield(L, LUA_REGISTRYINDEX, "ta_scnotifications") == LUA_TTABLE &&
+      lua_rawgeti(L, -1, code) == LUA_TTABLE &&
+      lua_rawgeti(L, -1, 1) == LUA_TSTRING &&
+      lua_getfield(L, LUA_REGISTRYINDEX, "ta_events") == LUA_TTABLE) {
+    lua_pushvalue(L, -2);
+    if (lua_rawget(L, -2) == LUA_TTABLE) has_handlers = lua_rawlen(L, -1) > 0;
+  }
+  lua_settop(L, top);
+  return has_handlers;
+}
+
+/**
+ * Returns whether or not any handlers besides the one that emits notifications'
+ * mapped events (`events._scnotify`) are connected to the 'SCN' event.
+ * Such handlers want every notification, mapped or not.
+ * @param L The Lua state.
+ * @return TRUE or FALSE
+ */
+static int l_hasrawnotificationhandlers(lua_State *L) {
+  if (!l_pusheventhandlers(L, "SCN")) return FALSE;
+  int has_handlers = FALSE;
+  lua_getfield(L, LUA_REGISTRYINDEX, "ta_scnotify");
+  for (size_t i = 1; i <= lua_rawlen(L, -2) && !has_handlers; i++) {
+    lua_rawgeti(L, -2, i);
+    has_handlers = !lua_rawequal(L, -1, -2), lua_pop(L, 1); // handler
+  }
+  return (lua_pop(L, 2), has_handlers); // ta_scnotify, handlers
+}
+
+/** `notification[field]` metamethod. */
+static int lnotification__index(lua_State *L) {
+  struct SCNotification *n = (struct SCNotification *)luaL_checkudata(L, 1,
+    "ta_scnotification");
+  const char *key = (lua_type(L, 2) == LUA_TSTRING) ? lua_tostring(L, 2) : "";
+  sptr_t value;
+  if (strcmp(key, "text") == 0) {
+    if (n->text && n->length)
+      lua_pushlstring(L, n->text, n->length);
+    else
+      lua_pushstring(L, n->text);
+    return 1;
+  } else if (strcmp(key, "code") == 0)
+    value = n->nmhdr.code;
+  else if (strcmp(key, "position") == 0)
+    value = n->position;
+  else if (strcmp(key, "ch") == 0)
+    value = n->ch;
+  else if (strcmp(key, "modifiers") == 0)
+    value = n->modifiers;
+  else if (strcmp(key, "modification_type") == 0)
+    value = n->modificationType;
+  else if (strcmp(key, "length") == 0)
+    value = n->length; // SCN_MODIFIED
+  else if (strcmp(key, "wParam") == 0)
+    value = n->wParam;
+  else if (strcmp(key, "line") == 0)
+    value = n->line;
+  else if (strcmp(key, "margin") == 0)
+    value = n->margin;
+  else if (strcmp(key, "x") == 0)
+    value = n->x;
+  else if (strcmp(key, "y") == 0)
+    value = n->y;
+  else if (strcmp(key, "updated") == 0)
+    value = n->updated;
+  else
+    return (lua_pushnil(L), 1);
+  return (lua_pushinteger(L, value), 1);
+}
+
 /**
  * Emits a Scintilla notification event.
+ * Notifications whose mapped events have no handlers are not emitted at all
+ * unless other handlers are connected to the 'SCN' event itself.
+ * Otherwise the notification is passed as a userdata whose fields are read on
+ * demand. Its text is only available while the event is being emitted.
  * @param L The Lua state.
  * @param n The Scintilla notification struct.
  * @see lL_event
  */
 static void lL_notify(lua_State *L, struct SCNotification *n) {
-  lua_newtable(L);
-  lua_pushinteger(L, n->nmhdr.code), lua_setfield(L, -2, "code");
-  lua_pushinteger(L, n->position), lua_setfield(L, -2, "position");
-  lua_pushinteger(L, n->ch), lua_setfield(L, -2, "ch");
-  lua_pushinteger(L, n->modifiers), lua_setfield(L, -2, "modifiers");
-  lua_pushinteger(L, n->modificationType);
-  lua_setfield(L, -2, "modification_type");
-  if (n->text && n->length)
-    lua_pushlstring(L, n->text, n->length), lua_setfield(L, -2, "text");
-  else
-    lua_pushstring(L, n->text), lua_setfield(L, -2, "text");
-  lua_pushinteger(L, n->length), lua_setfield(L, -2, "length"); // SCN_MODIFIED
-  //lua_pushinteger(L, n->linesAdded), lua_setfield(L, -2, "lines_added");
-  //lua_pushinteger(L, n->message), lua_setfield(L, -2, "message");
-  lua_pushinteger(L, n->wParam), lua_setfield(L, -2, "wParam");
-  //lua_pushinteger(L, n->lParam), lua_setfield(L, -2, "lParam");
-  lua_pushinteger(L, n->line), lua_setfield(L, -2, "line");
-  //lua_pushinteger(L, n->foldLevelNow), lua_setfield(L, -2, "fold_level_now");
-  //lua_pushinteger(L, n->foldLevelPrev);
-  //lua_setfield(L, -2, "fold_level_prev");
-  lua_pushinteger(L, n->margin), lua_setfield(L, -2, "margin");
-  lua_pushinteger(L, n->x), lua_setfield(L, -2, "x");
-  lua_pushinteger(L, n->y), lua_setfield(L, -2, "y");
-  //lua_pushinteger(L, n->token), lua_setfield(L, -2, "token");
-  //lua_pushinteger(L, n->annotationLinesAdded);
-  //lua_setfield(L, -2, "annotation_lines_added");
-  lua_pushinteger(L, n->updated), lua_setfield(L, -2, "updated");
-  //lua_pushinteger(L, n->listCompletionMethod);
-  //lua_setfield(L, -2, "list_completion_method");
+  if (!l_hasnotificationhandlers(L, n->nmhdr.code) &&
+      !l_hasrawnotificationhandlers(L))
+    return;
+  struct SCNotification *notification = (struct SCNotification *)
+    lua_newuserdata(L, sizeof(struct SCNotification));
+  *notification = *n;
+  if (luaL_newmetatable(L, "ta_scnotification"))
+    l_setcfunction(L, -1, "__index", lnotification__index);
+  lua_setmetatable(L, -2);
+  lua_pushvalue(L, -1); // keep alive until after the event
   lL_event(L, "SCN", LUA_TTABLE, luaL_ref(L, LUA_REGISTRYINDEX), -1);
+  notification->text = NULL; // no longer valid
+  lua_pop(L, 1); // notification
+}
+
+/**
+ * Limits the modification notifications sent by all Scintilla views to text
+ * insertions and deletions unless handlers are connected to the 'modified'
+ * event or to the 'SCN' event itself.
+ * Text slices only need insertions and deletions, so this avoids emitting a
+ * notification for every styling and marker change nobody listens to.
+ * @param L The Lua state.
+ */
+static void l_updatemodeventmask(lua_State *L) {
+  int mask = (l_hasnotificationhandlers(L, SCN_MODIFIED) ||
+              l_hasrawnotificationhandlers(L)) ? SC_MODEVENTMASKALL :
+    SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT;
+  if (mask == mod_event_mask) return;
+  mod_event_mask = mask;
+  lua_getfield(L, LUA_REGISTRYINDEX, "ta_views");
+  for (size_t i = 1; i <= lua_rawlen(L, -1); i++) {
+    Scintilla *view = (lua_rawgeti(L, -1, i), l_toview(L, -1));
+    lua_pop(L, 1); // view
+    SS(view, SCI_SETMODEVENTMASK, mask, 0);
+  }
+  lua_pop(L, 1); // views
+  SS(dummy_view, SCI_SETMODEVENTMASK, mask, 0);
+  SS(command_entry, SCI_SETMODEVENTMASK, mask, 0);
+}
+
+#if GTK
+/** Emits modification ranges once control returns to the main loop. */
+static int emit_modified_ranges(void*_) {
+  return (modified_ranges_idle = 0, lL_emitmodifiedranges(lua, 0), FALSE);
+}
+#endif
+
+/**
+ * Adds the given text insertion or deletion to the coalesced modification range
+ * for the given view's document if there are 'modified_range' event handlers.
+ * Ranges are only emitted later, outside of Scintilla's notification.
+ * @param view The Scintilla view that sent the notification.
+ * @param n The Scintilla notification struct.
+ * @see lL_emitmodifiedranges
+ */
+static void add_modified_range(Scintilla *view, struct SCNotification *n) {
+  if (!l_hashandlers(lua, "modified_range")) return;
+  sptr_t doc = SS(view, SCI_GETDOCPOINTER, 0, 0);
+  int pos = n->position, len = n->length;
+  int insert = n->modificationType & SC_MOD_INSERTTEXT;
+  ModifiedRange *range = NULL;
+  for (int i = 0; i < num_modified_ranges && !range; i++)
+    if (modified_ranges[i].doc == doc) range = &modified_ranges[i];
+  if (range) {
+    if (insert) {
+      // Shift the range end (and start) if text was inserted before it.
+      if (pos < range->start) range->start = pos;
+      if (pos <= range->end) range->end += len; else range->end = pos + len;
+    } else {
+      // Shift the range for the deleted text, collapsing any of it in the
+      // range to the deletion position, and then extend the range to include
+      // that position.
+      if (range->start > pos)
+        range->start = (range->start >= pos + len) ? range->start - len : pos;
+      if (range->end > pos)
+        range->end = (range->end >= pos + len) ? range->end - len : pos;
+      if (pos < range->start) range->start = pos;
+      if (pos > range->end) range->end = pos;
+    }
+    range->lines_added += n->linesAdded;
+    return;
+  }
+  if (num_modified_ranges == max_modified_ranges) {
+    max_modified_ranges = max_modified_ranges ? max_modified_ranges * 2 : 4;
+    modified_ranges = realloc(modified_ranges,
+                              max_modified_ranges * sizeof(ModifiedRange));
+  }
+  range = &modified_ranges[num_modified_ranges++];
+  range->doc = doc, range->start = pos, range->end = insert ? pos + len : pos;
+  range->lines_added = n->linesAdded;
+#if GTK
+  if (!modified_ranges_idle)
+    modified_ranges_idle = g_idle_add(emit_modified_ranges, NULL);
+#endif
+}
+
+/**
+ * Signal for a Scintilla notification from any view, including `dummy_view` and
+ * the command entry.
+ * Invalidates text slices and records modification ranges when text is
+ * inserted or deleted.
+ */
+static void s_modified(Scintilla *view, int _, void *lParam, void*__) {
+  struct SCNotification *n = (struct SCNotification *)lParam;
+  if (n->nmhdr.code == SCN_MODIFIED &&
+      (n->modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT)))
+    text_version++, add_modified_range(view, n);
 }
 
 /** Signal for a Scintilla notification. */
 static void s_notify(Scintilla *view, int _, void *lParam, void*__) {
   struct SCNotification *n = (struct SCNotification *)lParam;
+  s_modified(view, 0, lParam, NULL);
+  if (n->nmhdr.code == SCN_MODIFIED || n->nmhdr.code == SCN_UPDATEUI)
+    l_updatemodeventmask(lua);
   if (focused_view == view || n->nmhdr.code == SCN_URIDROPPED) {
     if (focused_view != view) goto_view(view);
     lL_notify(lua, n);
@@ -2182,6 +5035,7 @@ static Scintilla *new_view(sptr_t doc) {
   Scintilla *view = scintilla_new(s_notify);
 #endif
   SS(view, SCI_USEPOPUP, 0, 0);
+  SS(view, SCI_SETMODEVENTMASK, mod_event_mask, 0);
   lL_addview(lua, view);
   l_setglobalview(lua, view);
   if (doc) SS(view, SCI_SETDOCPOINTER, 0, doc);
@@ -2335,6 +5189,7 @@ static void new_window() {
   command_entry = scintilla_new();
   gtk_widget_set_size_request(command_entry, 1, 1);
   signal(command_entry, "key-press-event", s_keypress);
+  signal(command_entry, SCINTILLA_NOTIFY, s_modified);
   signal(command_entry, "focus-out-event", wc_focusout);
   gtk_paned_add2(GTK_PANED(paned), command_entry);
   gtk_container_child_set(GTK_CONTAINER(paned), command_entry, "shrink", FALSE,
@@ -2354,12 +5209,13 @@ static void new_window() {
   gtk_widget_hide(findbox), gtk_widget_hide(command_entry); // hide initially
 
   dummy_view = scintilla_new();
+  signal(dummy_view, SCINTILLA_NOTIFY, s_modified);
 #elif CURSES
   pane = pane_new(new_view(0)), pane_resize(pane, LINES - 2, COLS, 1, 0);
-  command_entry = scintilla_new(NULL);
+  command_entry = scintilla_new(s_modified);
   wresize(scintilla_get_window(command_entry), 1, COLS);
   mvwin(scintilla_get_window(command_entry), LINES - 2, 0);
-  dummy_view = scintilla_new(NULL);
+  dummy_view = scintilla_new(s_modified);
 #endif
   register_command_entry_doc();
 }
@@ -2432,14 +5288,54 @@ static TermKeyResult textadept_waitkey(TermKey *tk, TermKeyKey *key) {
                                : termkey_getkey_force(tk, key);
     if (res != TERMKEY_RES_AGAIN && res != TERMKEY_RES_NONE) return res;
     if (res == TERMKEY_RES_AGAIN) force = TRUE;
+    if (!force) {
+      lL_emitmodifiedranges(lua, 0);
+      lL_event(lua, "idle", -1); // undocumented
+    }
     // Wait for input.
     int nfds = lspawn_pushfds(lua);
     fd_set *fds = (fd_set *)lua_touserdata(lua, -1);
     FD_SET(0, fds); // monitor stdin
-    if (select(nfds, fds, NULL, NULL, force ? &timeout : NULL) > 0) {
+    if (save_pipe[0] >= 0) {
+      FD_SET(save_pipe[0], fds); // monitor finished saves
+      if (save_pipe[0] >= nfds) nfds = save_pipe[0] + 1;
+    }
+    struct timeval *wait = force ? &timeout : NULL;
+#if __linux__
+    if (watch_fd >= 0) {
+      FD_SET(watch_fd, fds); // monitor watched files
+      if (watch_fd >= nfds) nfds = watch_fd + 1;
+    }
+    struct timeval watch_wait = {0, 0};
+    if (watch_deadline && !force) {
+      long long us = (watch_deadline - l_nanotime()) / 1000;
+      if (us > 0)
+        watch_wait.tv_sec = us / 1000000, watch_wait.tv_usec = us % 1000000;
+      wait = &watch_wait; // wake up to report watched file changes
+    }
+#endif
+    if (select(nfds, fds, NULL, NULL, wait) > 0) {
       if (FD_ISSET(0, fds)) termkey_advisereadable(tk);
       if (lspawn_readfds(lua) > 0) refresh_all();
+      SaveJob *job;
+      if (save_pipe[0] >= 0 && FD_ISSET(save_pipe[0], fds) &&
+          read(save_pipe[0], &job, sizeof(job)) == sizeof(job))
+      {
+        finish_save(lua, job, TRUE);
+        refresh_all();
+      }
+#if __linux__
+      if (watch_fd >= 0 && FD_ISSET(watch_fd, fds) && read_watch_events() &&
+          !watch_deadline)
+        watch_deadline = l_nanotime() + WATCH_DELAY * 1000000LL;
+#endif
+    }
+#if __linux__
+    if (watch_deadline && l_nanotime() >= watch_deadline) {
+      watch_deadline = 0, emit_watch_events();
+      refresh_all();
     }
+#endif
     lua_pop(lua, 1); // fd_set
   }
 }
@@ -2456,6 +5352,9 @@ static TermKeyResult textadept_waitkey(TermKey *tk, TermKeyKey *key) {
  */
 int main(int argc, char **argv) {
 #if GTK
+#if !GLIB_CHECK_VERSION(2,32,0)
+  g_thread_init(NULL); // for saving and searching files in the background
+#endif
   gtk_init(&argc, &argv);
 #elif CURSES
   ta_tk = termkey_new(0, 0);
@@ -2519,7 +5418,12 @@ int main(int argc, char **argv) {
 #endif
 
   setlocale(LC_COLLATE, "C"), setlocale(LC_NUMERIC, "C"); // for Lua
-  if (lua = luaL_newstate(), !lL_init(lua, argc, argv, FALSE)) {
+  lua = luaL_newstate();
+#if LUA_VERSION_NUM >= 502
+  void *ud;
+  default_alloc = lua_getallocf(lua, &ud), lua_setallocf(lua, l_alloc, ud);
+#endif
+  if (!lL_init(lua, argc, argv, FALSE)) {
 #if CURSES
     endwin();
     termkey_destroy(ta_tk);
@@ -2621,6 +5525,7 @@ int main(int argc, char **argv) {
       }
       break;
     } else quit = FALSE;
+    lL_emitmodifiedranges(lua, 0);
     refresh_all();
     view = !command_entry_focused ? focused_view : command_entry;
   }